@@ -0,0 +1,76 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "common.hpp"
+#include "arithmetic.hpp"
+#include "kernels.hpp"
+#include "ntru/keys.hpp"
+#include "ntru/ntru.hpp"
+
+#include "bench_common.hpp"
+
+// Число обращений к куче в установившемся режиме: после прогрева sign_strict и
+// verify_signature с переиспользуемой Signature не должны выделять память.
+// Проверяются зарегистрированный набор (специализированные ядра), незарегистрированный N
+// (общие ядра) и он же с принудительно отключённым uint16-путём (арифметика int, как при
+// Q != 2^k). Использование: bench_alloc [R]; код возврата 1 -- есть выделения.
+
+static std::atomic<long long> g_allocs{0};
+
+void *operator new(const std::size_t size) {
+  g_allocs.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+
+void *operator new[](const std::size_t size) { return operator new(size); }
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete[](void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+static bool Run(const int n, const bool forceGeneric, const int R) {
+  SignerContext ctx;
+  Params &P = ctx.params;
+  SetDefaultBenchParams(P, n);
+  if (!PrepareBenchContext(ctx, {.forceGeneric = forceGeneric})) return false;
+
+  const std::vector<uint8_t> msg(4096, 0x5A);
+  Signature S;
+  // прогрев: арена потока, таблица CDT, состояние хэша и векторы S
+  for (int i = 0; i < 3; ++i)
+    if (!sign_strict(ctx, msg, S) || verify_signature(ctx, msg, S) != SigStatus::Ok) {
+      std::printf("N=%d: подпись не прошла проверку\n", n);
+      return false;
+    }
+
+  const long long before = g_allocs.load();
+  int failed = 0;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < R; ++r) {
+    if (!sign_strict(ctx, msg, S)) ++failed;
+    else if (verify_signature(ctx, msg, S) != SigStatus::Ok) ++failed;
+  }
+  const double dt = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+  const long long allocs = g_allocs.load() - before;
+  std::printf("N=%4d kernels=%-14s path=%-7s allocs=%lld  sign+verify=%8.1f us  failed=%d\n", n,
+              P.kernels->set ? P.kernels->set->name : "generic", P.pow2 ? "pow2" : "generic", allocs, dt / R, failed);
+  return allocs == 0 && failed == 0;
+}
+
+int main(int argc, char **argv) {
+  const int R = argc > 1 ? std::atoi(argv[1]) : 100;
+  bool ok = true;
+  ok &= Run(503, false, R);
+  ok &= Run(509, false, R);
+  ok &= Run(509, true, R);
+  std::printf("steady state: %s\n", ok ? "no heap allocations" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "common.hpp"
+#include "arithmetic.hpp"
+#include "ntru/codec.hpp"
+#include "ntru/keys.hpp"
+#include "ntru/ntru.hpp"
+
+#include "bench_common.hpp"
+
+// Размер и скорость компактной подписи (codec.hpp) против Raw (3N uint16): COUNT подписей
+// кодируются и раскодируются в нескольких раундах, печатается лучший. Раскодированные
+// подписи должны совпасть с исходными и проходить проверку, обрезанные данные --
+// отвергаться.
+// Использование: bench_codec [COUNT] [KEY=VALUE ...], KEY -- как в bench_common.hpp.
+
+int main(int argc, char **argv) {
+  const int count = argc > 1 ? std::atoi(argv[1]) : 2000;
+
+  SignerContext ctx;
+  Params &P = ctx.params;
+  SetDefaultBenchParams(P);
+  const BenchOptions opt = ApplyBenchArgs(P, argc, argv, 2);
+  if (!PrepareBenchContext(ctx, opt)) return 1;
+
+  std::vector<Signature> sigs(count);
+  for (int i = 0; i < count; ++i) {
+    const std::vector<uint8_t> msg(64, static_cast<uint8_t>(i));
+    if (!sign_strict(ctx, msg, sigs[i])) {
+      std::printf("подпись %d не удалась\n", i);
+      return 1;
+    }
+  }
+
+  const size_t bound = compact_signature_bound(P);
+  std::vector<uint8_t> enc(static_cast<size_t>(count) * bound);
+  std::vector<size_t> len(count);
+  std::vector<Signature> dec(count);
+  double bestEnc = 1e300, bestDec = 1e300;
+  bool decoded = true;
+  for (int round = 0; round < 3; ++round) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i)
+      len[i] = encode_compact(P, sigs[i], std::span<uint8_t>(enc.data() + i * bound, bound));
+    bestEnc = std::min(bestEnc, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count());
+    t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i)
+      decoded &= decode_compact(P, std::span<const uint8_t>(enc.data() + i * bound, len[i]), dec[i]);
+    bestDec = std::min(bestDec, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count());
+  }
+
+  size_t total = 0, maxLen = 0;
+  int same = 0, valid = 0, rejected = 0;
+  for (int i = 0; i < count; ++i) {
+    total += len[i];
+    maxLen = std::max(maxLen, len[i]);
+    same += dec[i].x1 == sigs[i].x1 && dec[i].x2 == sigs[i].x2 && dec[i].e == sigs[i].e;
+    valid += verify_signature(ctx, std::vector<uint8_t>(64, static_cast<uint8_t>(i)), dec[i]) == SigStatus::Ok;
+    Signature cut;
+    rejected += !decode_compact(P, std::span<const uint8_t>(enc.data() + i * bound, len[i] - 1), cut);
+  }
+  const double raw = 6.0 * P.N;
+  const double avg = static_cast<double>(total) / count;
+  std::printf("N=%d Q=%d SIGMA=%d ALPHA=%d, подписей=%d\n", P.N, P.Q, P.SIGMA, P.ALPHA, count);
+  std::printf("raw      %8.0f байт\n", raw);
+  std::printf("compact  %8.1f байт в среднем, %zu наибольший, граница %zu, x%.2f\n", avg, maxLen, bound, raw / avg);
+  std::printf("encode   %8.2f us/подпись\n", bestEnc / count);
+  std::printf("decode   %8.2f us/подпись\n", bestDec / count);
+
+  const bool ok = decoded && same == count && valid == count && rejected == count;
+  std::printf("roundtrip: %s (same=%d, verified=%d, truncated rejected=%d)\n", ok ? "identical" : "MISMATCH", same,
+              valid, rejected);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "common.hpp"
+#include "arithmetic.hpp"
+#include "ntru/keys.hpp"
+
+// Общая подготовка бенчмарков: параметры по умолчанию (N=503, Q=2048), разбор аргументов
+// KEY=VALUE (KEY -- N, Q, D, ETA, SIGMA, ALPHA, NORM_BOUND) и GENERIC, генерация ключа.
+
+struct BenchOptions {
+  bool forceGeneric = false; // GENERIC: отключить uint16-путь (арифметика int, как при Q != 2^k)
+};
+
+inline void SetDefaultBenchParams(Params &P, const int n = 503) {
+  P.N = n;
+  P.Q = 2048;
+  P.D = 101;
+  P.NU = 1.0;
+  P.NORM_BOUND = 1000;
+  P.ETA = 1.3;
+  P.ALPHA = 2;
+  P.SIGMA = 100;
+}
+
+// false -- аргумент не KEY=VALUE и не GENERIC
+inline bool ApplyBenchArg(Params &P, BenchOptions &opt, const char *arg) {
+  if (std::strcmp(arg, "GENERIC") == 0) {
+    opt.forceGeneric = true;
+    return true;
+  }
+  const char *eq = std::strchr(arg, '=');
+  if (!eq) return false;
+  const std::string k(arg, eq);
+  const double v = std::atof(eq + 1);
+  if (k == "N") P.N = static_cast<int>(v);
+  else if (k == "Q") P.Q = static_cast<int>(v);
+  else if (k == "D") P.D = static_cast<int>(v);
+  else if (k == "ETA") P.ETA = v;
+  else if (k == "SIGMA") P.SIGMA = static_cast<int>(v);
+  else if (k == "ALPHA") P.ALPHA = static_cast<int>(v);
+  else if (k == "NORM_BOUND") P.NORM_BOUND = static_cast<int>(v);
+  else return false;
+  return true;
+}
+
+inline BenchOptions ApplyBenchArgs(Params &P, const int argc, char **argv, const int first) {
+  BenchOptions opt;
+  for (int i = first; i < argc; ++i)
+    if (!ApplyBenchArg(P, opt, argv[i])) std::printf("неизвестный аргумент пропущен: %s\n", argv[i]);
+  return opt;
+}
+
+// prepareParams и keygen для ctx.params; при ошибке печатает сообщение
+inline bool PrepareBenchContext(SignerContext &ctx, const BenchOptions &opt = {}) {
+  Params &P = ctx.params;
+  prepareParams(P);
+  if (opt.forceGeneric) P.pow2 = false;
+  if (!keygen(ctx)) {
+    std::printf("N=%d: keygen не удался\n", P.N);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,104 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+
+#include "drbg.hpp"
+#include "gauss.hpp"
+
+// Скорость и проверка распределения табличного сэмплера против sample_gauss_int.
+// Использование: bench_gauss [SIGMA] [N] [SAMPLES]
+// Проверка: критерий хи-квадрат для CDT против точных вероятностей округлённого
+// нормального и двухвыборочный хи-квадрат CDT против старого сэмплера.
+// Код возврата 1, если статистика выходит за 99.9%-квантиль.
+
+namespace {
+  // прежний сэмплер (округление std::normal_distribution) -- эталон для сравнения
+  int sample_gauss_int(std::mt19937 &rng, const double sigma) {
+    std::normal_distribution<double> norm01(0.0, 1.0);
+    const double x = norm01(rng) * sigma;
+    long long y = llround(x);
+    if (y > (1ll << 31) - 1) y = (1ll << 31) - 1;
+    if (y < -(1ll << 31)) y = -(1ll << 31);
+    return static_cast<int>(y);
+  }
+
+  double rounded_normal_p(const int k, const double sigma) {
+    const double s = sigma * std::sqrt(2.0);
+    return 0.5 * (std::erfc((k - 0.5) / s) - std::erfc((k + 0.5) / s));
+  }
+
+  // 99.9%-квантиль хи-квадрат (приближение Уилсона-Хилферти)
+  double chi2_crit(const int df) {
+    const double z = 3.0902;
+    const double a = 2.0 / (9.0 * df);
+    return df * std::pow(1.0 - a + z * std::sqrt(a), 3.0);
+  }
+
+  // объединяем k в корзины шириной sigma/4, хвосты -- в крайние корзины
+  int bucket(const int k, const double sigma) {
+    const int w = std::max(1, static_cast<int>(sigma / 4));
+    const int lim = 16;
+    int b = (k >= 0 ? k / w : -((-k + w - 1) / w));
+    if (b > lim) b = lim;
+    if (b < -lim) b = -lim;
+    return b;
+  }
+}
+
+int main(int argc, char **argv) {
+  const double sigma = argc > 1 ? std::atof(argv[1]) : 100.0;
+  const int n = argc > 2 ? std::atoi(argv[2]) : 503;
+  const int samples = argc > 3 ? std::atoi(argv[3]) : 2000000;
+
+  std::mt19937 rng(777);
+  const DiscreteGaussCDT &cdt = gaussCDT(sigma);
+
+  // скорость: заполнение y1, y2 длины N, как в одной попытке подписи
+  std::vector<int> y(2 * n);
+  const int reps = std::max(1, samples / (2 * n));
+  auto t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < reps; ++r)
+    for (int i = 0; i < 2 * n; ++i) y[i] = sample_gauss_int(rng, sigma);
+  const double usOld = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / reps;
+  t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < reps; ++r) cdt.fill(rng, y.data(), y.size());
+  const double usNew = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / reps;
+  drbgSeed(777);
+  ChaChaDrbg &chacha = threadDrbg();
+  t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < reps; ++r) cdt.fill(chacha, y.data(), y.size());
+  const double usChaCha = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / reps;
+  std::printf("sigma=%.1f, 2N=%d: sample_gauss_int %.2f us, CDT %.2f us (x%.1f), CDT+ChaCha20 %.2f us\n", sigma,
+              2 * n, usOld, usNew, usOld / usNew, usChaCha);
+
+  // распределение
+  std::map<int, long long> cntNew, cntOld;
+  std::map<int, double> expect;
+  for (int i = 0; i < samples; ++i) {
+    ++cntNew[bucket(cdt.sample(rng), sigma)];
+    ++cntOld[bucket(sample_gauss_int(rng, sigma), sigma)];
+  }
+  const int kmax = static_cast<int>(20 * sigma) + 10;
+  for (int k = -kmax; k <= kmax; ++k) expect[bucket(k, sigma)] += rounded_normal_p(k, sigma) * samples;
+
+  double chiExact = 0, chiTwo = 0;
+  int dfExact = -1, dfTwo = -1;
+  for (const auto &[b, e]: expect) {
+    if (e < 5) continue;
+    const double o = static_cast<double>(cntNew[b]);
+    chiExact += (o - e) * (o - e) / e;
+    ++dfExact;
+    const double a = static_cast<double>(cntNew[b]), c = static_cast<double>(cntOld[b]);
+    if (a + c > 0) {
+      chiTwo += (a - c) * (a - c) / (a + c);
+      ++dfTwo;
+    }
+  }
+  const bool okExact = chiExact <= chi2_crit(dfExact), okTwo = chiTwo <= chi2_crit(dfTwo);
+  std::printf("CDT vs точное:        chi2=%.2f df=%d crit(99.9%%)=%.2f %s\n", chiExact, dfExact, chi2_crit(dfExact), okExact ? "OK" : "FAIL");
+  std::printf("CDT vs старый сэмплер: chi2=%.2f df=%d crit(99.9%%)=%.2f %s\n", chiTwo, dfTwo, chi2_crit(dfTwo), okTwo ? "OK" : "FAIL");
+  return okExact && okTwo ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "kernels.hpp"
+#include "multiplication.hpp"
+
+// Сравнение методов умножения по N: время одного mulCyclicModQ и проверка
+// совпадения результата со школьным методом. Затем для наборов из PARAM_SETS --
+// специализированное ядро mulModQ против общего пути и uint16-ядро mulPow2 (Q = 2^k),
+// и те же ядра с подготовленным вторым сомножителем (prepareOperand, как у открытого ключа).
+// Использование: bench_mul [Q] [N1 N2 ...]
+
+template<typename Mul>
+static double timeMul(const Mul &mul) {
+  int reps = 1;
+  while (true) {
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; ++r) {
+      volatile int sink = mul()[0];
+      (void) sink;
+    }
+    const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    if (us > 200000.0 || reps >= (1 << 20)) return us / reps;
+    reps *= 2;
+  }
+}
+
+int main(int argc, char **argv) {
+  const int q = argc > 1 ? std::atoi(argv[1]) : 2048;
+  std::vector<int> sizes;
+  for (int i = 2; i < argc; ++i) sizes.push_back(std::atoi(argv[i]));
+  if (sizes.empty()) sizes = {32, 48, 64, 96, 128, 192, 251, 347, 401, 503, 743, 1024, 1499, 2048};
+
+  std::mt19937 rng(12345);
+  std::uniform_int_distribution<int> coef(0, q - 1);
+  constexpr MulMethod methods[] = {MulMethod::Schoolbook, MulMethod::Karatsuba, MulMethod::Toom4};
+
+  std::printf("%6s %14s %14s %14s   %-10s %s\n", "N", "schoolbook,us", "karatsuba,us", "toom4,us", "best", "chosen");
+  for (const int n: sizes) {
+    Poly A(n), B(n);
+    for (int i = 0; i < n; ++i) {
+      A[i] = coef(rng);
+      B[i] = coef(rng);
+    }
+    const Poly ref = mulCyclicModQ(A, B, n, q, MulMethod::Schoolbook);
+
+    double t[3];
+    int best = 0;
+    for (int m = 0; m < 3; ++m) {
+      if (mulCyclicModQ(A, B, n, q, methods[m]) != ref) {
+        std::printf("N=%d: %s расходится со школьным методом\n", n, mulMethodName(methods[m]));
+        return 1;
+      }
+      t[m] = timeMul([&] { return mulCyclicModQ(A, B, n, q, methods[m]); });
+      if (t[m] < t[best]) best = m;
+    }
+    std::printf("%6d %14.2f %14.2f %14.2f   %-10s %s\n", n, t[0], t[1], t[2], mulMethodName(methods[best]),
+                mulMethodName(chooseMulMethod(n)));
+  }
+
+  std::printf("\n%-16s %12s %14s %10s %14s %12s\n", "набор", "generic,us", "specialized,us", "pow2,us",
+              "prepared,us", "pow2 prep,us");
+  for (const ParamSet &p: PARAM_SETS) {
+    const int n = p.n;
+    std::uniform_int_distribution<int> c(0, p.q - 1);
+    Poly A(n), B(n);
+    for (int i = 0; i < n; ++i) {
+      A[i] = c(rng);
+      B[i] = c(rng);
+    }
+    Params P;
+    P.N = n;
+    P.Q = p.q;
+    const RingKernels &k = selectKernels(n, p.q);
+    const Poly ref = mulCyclicModQ(A, B, n, p.q, MulMethod::Schoolbook);
+    Poly R(n);
+    k.mulModQ(P, A, B, R);
+    if (k.set != &p || R != ref) {
+      std::printf("%s: специализированное ядро расходится со школьным методом\n", p.name);
+      return 1;
+    }
+    const double tg = timeMul([&] { return mulCyclicModQ(A, B, n, p.q, chooseMulMethod(n)); });
+    const double ts = timeMul([&] {
+      k.mulModQ(P, A, B, R);
+      return R;
+    });
+
+    Poly16 A16(A.begin(), A.end()), B16(B.begin(), B.end()), R16(n);
+    k.mulPow2(P, A16, B16, R16);
+    for (int i = 0; i < n; ++i)
+      if ((R16[i] & (p.q - 1)) != ref[i]) {
+        std::printf("%s: mulPow2 расходится со школьным методом\n", p.name);
+        return 1;
+      }
+    const double t16 = timeMul([&] {
+      k.mulPow2(P, A16, B16, R16);
+      return R16;
+    });
+
+    PreparedOperand<long long> Bp;
+    PreparedOperand<uint16_t> Bp16;
+    prepareOperand(B.data(), n, chooseMulMethod(n), Bp);
+    prepareOperand16(B16.data(), n, Bp16);
+    Poly Rg(n);
+    k.mulPreparedModQ(P, A, Bp, R);
+    GENERIC_KERNELS.mulPreparedModQ(P, A, Bp, Rg);
+    Poly16 Rp16(n);
+    k.mulPreparedPow2(P, A16, Bp16, Rp16);
+    bool same = R == ref && Rg == ref;
+    for (int i = 0; i < n; ++i) same &= (Rp16[i] & (p.q - 1)) == ref[i];
+    if (!same) {
+      std::printf("%s: умножение на подготовленный операнд расходится со школьным методом\n", p.name);
+      return 1;
+    }
+    const double tp = timeMul([&] {
+      k.mulPreparedModQ(P, A, Bp, R);
+      return R;
+    });
+    const double tp16 = timeMul([&] {
+      k.mulPreparedPow2(P, A16, Bp16, Rp16);
+      return Rp16;
+    });
+    std::printf("%-16s %12.2f %14.2f %10.2f %14.2f %12.2f\n", p.name, tg, ts, t16, tp, tp16);
+  }
+  return 0;
+}
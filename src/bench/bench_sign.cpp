@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "common.hpp"
+#include "drbg.hpp"
+#include "arithmetic.hpp"
+#include "kernels.hpp"
+#include "ntru/keys.hpp"
+#include "ntru/ntru.hpp"
+#include "ntru/presign.hpp"
+
+#include "bench_common.hpp"
+
+// Задержка одной подписи: последовательный sign_strict против sign_parallel на K потоках.
+// Использование: bench_sign [K] [R] [KEY=VALUE ...], KEY -- N, Q, D, ETA, SIGMA, ALPHA, NORM_BOUND
+// (bench_common.hpp).
+// Малый ETA даёт много отказов на подпись -- там параллельные попытки и выигрывают.
+// presign -- онлайн-задержка с пулом предвычисленных масок (presign.hpp); между запросами
+// пауза, за которую фоновый поток пополняет пул.
+// batch -- пропускная способность: R коротких сообщений через sign_batch против sign_strict
+// в цикле.
+// В конце проверяется, что при одном зерне (drbgSeed) все версии выдают одну и ту же подпись.
+
+static void Report(const char *name, std::vector<double> us, const int failed) {
+  std::ranges::sort(us);
+  auto pct = [&](const double p) { return us.empty() ? 0.0 : us[std::min(us.size() - 1, static_cast<size_t>(p * us.size()))]; };
+  double mean = 0;
+  for (const double v: us) mean += v;
+  if (!us.empty()) mean /= static_cast<double>(us.size());
+  std::printf("%-14s p50=%10.1f us  p99=%10.1f us  mean=%10.1f us  failed=%d\n", name, pct(0.50), pct(0.99), mean, failed);
+}
+
+int main(int argc, char **argv) {
+  const unsigned K = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 4;
+  const int R = argc > 2 ? std::atoi(argv[2]) : 200;
+
+  SignerContext ctx;
+  Params &P = ctx.params;
+  SetDefaultBenchParams(P);
+  P.ETA = 1.02;
+  const BenchOptions opt = ApplyBenchArgs(P, argc, argv, 3);
+  if (!PrepareBenchContext(ctx, opt)) return 1;
+  std::printf("N=%d Q=%d ETA=%.3f SIGMA=%d, K=%u, R=%d, kernels=%s\n", P.N, P.Q, P.ETA, P.SIGMA, K, R,
+              P.kernels->set ? P.kernels->set->name : "generic");
+
+  const std::vector<uint8_t> msg(4096, 0x5A);
+  auto run = [&](const char *name, const unsigned threads) {
+    std::vector<double> us;
+    int failed = 0;
+    for (int r = 0; r < R; ++r) {
+      Signature S;
+      const auto t0 = std::chrono::steady_clock::now();
+      const bool ok = sign_parallel(ctx, msg, S, threads);
+      const double dt = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+      if (ok) us.push_back(dt);
+      else ++failed;
+    }
+    Report(name, us, failed);
+  };
+  run("sequential", 1);
+  run("parallel", K);
+
+  constexpr size_t POOL = 32;
+  auto waitFull = [](const PresignPool &pool) {
+    while (pool.stats().produced < pool.capacity()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  };
+  {
+    PresignPool pool(ctx, POOL);
+    waitFull(pool);
+    std::vector<double> us;
+    int failed = 0;
+    for (int r = 0; r < R; ++r) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      Signature S;
+      const auto t0 = std::chrono::steady_clock::now();
+      const bool ok = pool.sign(msg, S);
+      const double dt = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+      if (ok) us.push_back(dt);
+      else ++failed;
+    }
+    Report("presign", us, failed);
+    const PresignStats st = pool.stats();
+    std::printf("presign pool=%zu: produced=%llu from_pool=%llu empty=%llu (%.1f%%)\n", POOL,
+                static_cast<unsigned long long>(st.produced), static_cast<unsigned long long>(st.fromPool),
+                static_cast<unsigned long long>(st.empty), 100.0 * st.emptyRate());
+  }
+
+  // короткие разные сообщения: пакет против цикла sign_strict, лучший из трёх раундов
+  std::vector<std::vector<uint8_t>> msgs(R, std::vector<uint8_t>(64));
+  for (int i = 0; i < R; ++i)
+    for (size_t j = 0; j < msgs[i].size(); ++j) msgs[i][j] = static_cast<uint8_t>(i * 131 + j * 7);
+  std::vector<Signature> loopSigs(R), batchSigs(R);
+  double bestLoop = 1e300, bestBatch = 1e300;
+  int loopFailed = 0, batchFailed = 0;
+  for (int round = 0; round < 3; ++round) {
+    loopFailed = batchFailed = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < R; ++i) loopFailed += !sign_strict(ctx, msgs[i], loopSigs[i]);
+    bestLoop = std::min(bestLoop, std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+    t0 = std::chrono::steady_clock::now();
+    const std::vector<bool> ok = sign_batch(ctx, msgs, batchSigs);
+    bestBatch = std::min(bestBatch, std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+    batchFailed = static_cast<int>(std::ranges::count(ok, false));
+  }
+  std::printf("%-14s %10.0f сообщений/с  failed=%d\n", "strict loop", R / bestLoop, loopFailed);
+  std::printf("%-14s %10.0f сообщений/с  failed=%d  (x%.2f)\n", "batch", R / bestBatch, batchFailed, bestLoop / bestBatch);
+
+  Signature seq, par, pre;
+  drbgSeed(12345);
+  const bool okSeq = sign_strict(ctx, msg, seq);
+  drbgSeed(12345);
+  const bool okPar = sign_parallel(ctx, msg, par, K);
+  // полный пул отдаёт маски в порядке потоков ChaCha20 -- как попытки sign_strict
+  drbgSeed(12345);
+  bool okPre;
+  {
+    PresignPool pool(ctx, POOL);
+    waitFull(pool);
+    okPre = pool.sign(msg, pre) && pool.stats().empty == 0;
+  }
+  drbgSeed(12345);
+  for (int i = 0; i < R; ++i) loopFailed += !sign_strict(ctx, msgs[i], loopSigs[i]);
+  drbgSeed(12345);
+  const std::vector<bool> batchOk = sign_batch(ctx, msgs, batchSigs);
+  bool sameBatch = std::ranges::count(batchOk, false) == 0;
+  for (int i = 0; i < R; ++i)
+    sameBatch &= loopSigs[i].x1 == batchSigs[i].x1 && loopSigs[i].x2 == batchSigs[i].x2 && loopSigs[i].e == batchSigs[i].e;
+  drbgSeedFromEntropy();
+  const bool same = okSeq && okPar && seq.x1 == par.x1 && seq.x2 == par.x2 && seq.e == par.e;
+  const bool samePre = okSeq && okPre && seq.x1 == pre.x1 && seq.x2 == pre.x2 && seq.e == pre.e;
+  std::printf("seeded replay: %s, presign: %s, batch: %s\n", same ? "identical" : "MISMATCH",
+              samePre ? "identical" : "MISMATCH", sameBatch ? "identical" : "MISMATCH");
+  return same && samePre && sameBatch ? 0 : 1;
+}
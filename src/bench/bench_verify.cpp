@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+
+#include "common.hpp"
+#include "arithmetic.hpp"
+#include "kernels.hpp"
+#include "ntru/keys.hpp"
+#include "ntru/ntru.hpp"
+
+#include "bench_common.hpp"
+
+// Проверка многих подписей одним ключом: verify_signature с подготовленным открытым
+// ключом (PreparedPublicKey), тот же контекст без него (обычное умножение на h) и
+// verify_batch (пачки по MUL_BATCH_LANES). Варианты чередуются в нескольких раундах,
+// печатается лучший; каждая десятая подпись испорчена, решения всех вариантов должны совпасть.
+// Использование: bench_verify [COUNT] [MSG_BYTES] [KEY=VALUE ...] [GENERIC], KEY -- N, Q, D, ETA,
+// SIGMA, ALPHA, NORM_BOUND (bench_common.hpp); GENERIC отключает uint16-путь.
+
+int main(int argc, char **argv) {
+  const int count = argc > 1 ? std::atoi(argv[1]) : 10000;
+  const size_t msgBytes = argc > 2 ? static_cast<size_t>(std::atoi(argv[2])) : 64;
+
+  SignerContext ctx;
+  Params &P = ctx.params;
+  SetDefaultBenchParams(P);
+  const BenchOptions opt = ApplyBenchArgs(P, argc, argv, 3);
+  if (!PrepareBenchContext(ctx, opt)) return 1;
+  std::printf("N=%d Q=%d, подписей=%d, сообщение=%zu байт, kernels=%s, path=%s\n", P.N, P.Q, count, msgBytes,
+              P.kernels->set ? P.kernels->set->name : "generic", P.pow2 ? "pow2" : "generic");
+
+  std::vector<std::vector<uint8_t>> msgs(count, std::vector<uint8_t>(msgBytes));
+  std::vector<Signature> sigs(count);
+  for (int i = 0; i < count; ++i) {
+    for (size_t j = 0; j < msgBytes; ++j) msgs[i][j] = static_cast<uint8_t>(i * 131 + j * 7);
+    if (!sign_strict(ctx, msgs[i], sigs[i])) {
+      std::printf("подпись %d не удалась\n", i);
+      return 1;
+    }
+    if (i % 10 == 9) sigs[i].x1[i % P.N] = (sigs[i].x1[i % P.N] + 1) % P.Q;
+  }
+
+  VerifierContext plain = ctx;
+  plain.hp = PreparedPublicKey{};
+
+  auto run = [&](const VerifierContext &vc, std::vector<SigStatus> &st) {
+    st.assign(count, SigStatus::Ok);
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) st[i] = verify_signature(vc, msgs[i], sigs[i]);
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+  };
+  auto runBatch = [&](std::vector<SigStatus> &st) {
+    st.assign(count, SigStatus::Ok);
+    const auto t0 = std::chrono::steady_clock::now();
+    const std::vector<bool> bits = verify_batch(ctx, msgs, sigs, st);
+    const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    for (int i = 0; i < count; ++i)
+      if (bits[i] != (st[i] == SigStatus::Ok)) st[i] = SigStatus::WriteError; // битовая карта разошлась со статусом
+    return us;
+  };
+  std::vector<SigStatus> a, b, c;
+  double bestPlain = 1e300, bestPrepared = 1e300, bestBatch = 1e300;
+  for (int round = 0; round < 3; ++round) {
+    bestPlain = std::min(bestPlain, run(plain, a));
+    bestPrepared = std::min(bestPrepared, run(ctx, b));
+    bestBatch = std::min(bestBatch, runBatch(c));
+  }
+  for (const auto &[name, us]: {std::pair{"plain h", bestPlain}, std::pair{"prepared", bestPrepared},
+                                std::pair{"batch", bestBatch}})
+    std::printf("%-10s %10.2f us/подпись  %10.0f подписей/с\n", name, us / count, 1e6 * count / us);
+
+  int ok = 0;
+  for (const SigStatus s: b) ok += s == SigStatus::Ok;
+  const bool same = a == b && b == c && ok == count - count / 10;
+  std::printf("решения: %s (ok=%d)\n", same ? "identical" : "MISMATCH", ok);
+  return same ? 0 : 1;
+}
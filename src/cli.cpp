@@ -0,0 +1,312 @@
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "console/utils.hpp"
+#include "drbg.hpp"
+#include "ntru/keys.hpp"
+#include "ntru/presign.hpp"
+#include "operations.hpp"
+
+// Неинтерактивный интерфейс для скриптов:
+//   digital_signature_cli keygen  -p params.txt --pub public.key --priv private.key [--text-key]
+//   digital_signature_cli pubkey  -p params.txt --pub public.key -o out.key [--text-key]
+//   digital_signature_cli sign    -p params.txt -k private.key [-j N] [--sign-threads K | --presign M] [--detached] [--compact] [-l list.txt] file...
+//   digital_signature_cli verify  -p params.txt --pub public.key [-j N] [-l list.txt] file.signed|file.sig...
+//   digital_signature_cli extract -p params.txt [-j N] [-l list.txt] file.signed...
+// --presign M -- офлайн/онлайн-подпись: фоновый поток держит пул из M масок (presign.hpp),
+// статистика пула печатается в stderr.
+// --detached -- отсоединённая подпись file.sig (заголовок и подпись, без копии файла);
+// --compact -- компактная подпись (SGN2/SIG2: код Голомба-Райса, codec.hpp) вместо 3N uint16;
+// verify различает .signed и .sig и кодировку подписи по магии.
+// Открытый ключ пишется в двоичном формате NPK1, --text-key -- текстом (для обмена); читаются
+// оба. pubkey переписывает ключ в нужный формат. keygen и pubkey печатают отпечаток ключа в stderr.
+// --seed S делает генерацию ключей воспроизводимой (ChaCha20 от S вместо энтропии ОС). Для sign
+// зерно принимается только в сборке с FLAG_BENCH: при одном зерне подписи разных файлов берут
+// одни и те же маски y1/y2, а x1 = y1 - s раскрывает закрытый ключ.
+// Параметры и ключи загружаются в контекст один раз на запуск и из потоков (-j N) только читаются.
+// На каждый файл в stdout печатается строка "<статус>\t<путь>", итог -- в stderr.
+// Код возврата: 0 -- все файлы успешно, 1 -- есть ошибки, 2 -- ошибка запуска.
+
+namespace {
+  struct CliArgs {
+    std::string command;
+    std::string params;
+    std::string pub;
+    std::string priv;
+    std::string out;
+    std::vector<std::string> files;
+    unsigned threads = 1;
+    unsigned signThreads = 1;
+    size_t presign = 0;
+    bool detached = false;
+    bool compact = false;
+    bool textKey = false;
+    bool seeded = false;
+    uint64_t seed = 0;
+  };
+
+  void PrintUsage() {
+    std::cerr << "Использование:\n"
+        << "  digital_signature_cli keygen  -p PARAMS --pub PUBLIC_KEY --priv PRIVATE_KEY [--text-key]\n"
+        << "  digital_signature_cli pubkey  -p PARAMS --pub PUBLIC_KEY -o OUT_KEY [--text-key]\n"
+        << "  digital_signature_cli sign    -p PARAMS -k PRIVATE_KEY [-j N] [--sign-threads K | --presign M] [--detached] [--compact] [-l LIST] FILE...\n"
+        << "  digital_signature_cli verify  -p PARAMS --pub PUBLIC_KEY [-j N] [-l LIST] FILE.signed|FILE.sig...\n"
+        << "  digital_signature_cli extract -p PARAMS [-j N] [-l LIST] FILE.signed...\n"
+        << "LIST -- файл со списком путей (по одному в строке), '-' -- stdin\n"
+        << "-j N -- число потоков для пакетной обработки (0 -- по числу ядер, по умолчанию 1)\n"
+        << "--sign-threads K -- K параллельных попыток на одну подпись (sign)\n"
+        << "--presign M -- пул из M предвычисленных масок, пополняемый в фоне (sign)\n"
+        << "--detached -- подпись в FILE.sig без копии файла (sign)\n"
+        << "--compact -- сжатая подпись, в несколько раз короче (sign)\n"
+        << "--text-key -- открытый ключ текстом вместо двоичного формата (keygen, pubkey)\n"
+        << "--seed S -- детерминированный режим ГПСЧ для keygen\n";
+  }
+
+  bool ReadList(const std::string &listPath, std::vector<std::string> &files) {
+    std::ifstream file;
+    std::istream *in = &std::cin;
+    if (listPath != "-") {
+      file.open(listPath);
+      if (!file) {
+        std::cerr << "Не удалось открыть список файлов: " << listPath << "\n";
+        return false;
+      }
+      in = &file;
+    }
+    std::string line;
+    while (std::getline(*in, line)) {
+      line = trim(line);
+      if (!line.empty()) files.push_back(line);
+    }
+    return true;
+  }
+
+  bool ParseArgs(const int argc, char **argv, CliArgs &args) {
+    if (argc < 2) return false;
+    args.command = argv[1];
+    for (int i = 2; i < argc; ++i) {
+      const std::string a = argv[i];
+      auto value = [&](std::string &dst) {
+        if (i + 1 >= argc) {
+          std::cerr << "Не указано значение для " << a << "\n";
+          return false;
+        }
+        dst = argv[++i];
+        return true;
+      };
+      if (a == "-p" || a == "--params") {
+        if (!value(args.params)) return false;
+      } else if (a == "--pub") {
+        if (!value(args.pub)) return false;
+      } else if (a == "-k" || a == "--priv") {
+        if (!value(args.priv)) return false;
+      } else if (a == "-o" || a == "--out") {
+        if (!value(args.out)) return false;
+      } else if (a == "-l" || a == "--list") {
+        std::string list;
+        if (!value(list) || !ReadList(list, args.files)) return false;
+      } else if (a == "-j" || a == "--threads") {
+        std::string n;
+        if (!value(n)) return false;
+        try {
+          args.threads = static_cast<unsigned>(std::stoul(n));
+        } catch (...) {
+          std::cerr << "Некорректное число потоков: " << n << "\n";
+          return false;
+        }
+      } else if (a == "--sign-threads") {
+        std::string n;
+        if (!value(n)) return false;
+        try {
+          args.signThreads = static_cast<unsigned>(std::stoul(n));
+        } catch (...) {
+          std::cerr << "Некорректное число потоков: " << n << "\n";
+          return false;
+        }
+      } else if (a == "--presign") {
+        std::string n;
+        if (!value(n)) return false;
+        try {
+          args.presign = static_cast<size_t>(std::stoul(n));
+        } catch (...) {
+          std::cerr << "Некорректный размер пула: " << n << "\n";
+          return false;
+        }
+      } else if (a == "--detached") {
+        args.detached = true;
+      } else if (a == "--compact") {
+        args.compact = true;
+      } else if (a == "--text-key") {
+        args.textKey = true;
+      } else if (a == "--seed") {
+        std::string n;
+        if (!value(n)) return false;
+        try {
+          args.seed = std::stoull(n);
+          args.seeded = true;
+        } catch (...) {
+          std::cerr << "Некорректное зерно: " << n << "\n";
+          return false;
+        }
+      } else if (a == "--") {
+        for (++i; i < argc; ++i) args.files.emplace_back(argv[i]);
+      } else if (!a.empty() && a[0] == '-' && a != "-") {
+        std::cerr << "Неизвестный ключ: " << a << "\n";
+        return false;
+      } else {
+        args.files.push_back(a);
+      }
+    }
+    if (args.params.empty()) {
+      std::cerr << "Не указан файл параметров (-p)\n";
+      return false;
+    }
+    return true;
+  }
+
+  PublicKeyFormat PubFormat(const CliArgs &args) {
+    return args.textKey ? PublicKeyFormat::Text : PublicKeyFormat::Binary;
+  }
+
+  // двоичный открытый ключ хранит коэффициенты в uint16
+  bool CheckPubFormat(const CliArgs &args, const Params &P) {
+    if (args.textKey || P.Q <= KEY_MAX_Q) return true;
+    std::cerr << args.command << ": двоичный открытый ключ требует Q <= " << KEY_MAX_Q << ", используйте --text-key\n";
+    return false;
+  }
+
+  void PrintFingerprint(const CliArgs &args, const VerifierContext &ctx) {
+    if (ctx.params.Q > KEY_MAX_Q) return; // отпечаток считается по uint16-коэффициентам
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx",
+                  static_cast<unsigned long long>(public_key_fingerprint(ctx.params, ctx.h)));
+    std::cerr << args.command << ": fingerprint=" << hex << "\n";
+  }
+
+  int RunKeygen(const CliArgs &args, SignerContext &ctx) {
+    if (args.pub.empty() || args.priv.empty()) {
+      std::cerr << "keygen: нужны --pub и --priv\n";
+      return 2;
+    }
+    if (!CheckPubFormat(args, ctx.params)) return 2;
+    if (!keygen(ctx)) {
+      std::cout << sigStatusName(SigStatus::SignFailed) << "\tkeygen\n";
+      return 1;
+    }
+    const bool okPub = ensure_parent_dirs(args.pub) && WritePublicKey(ctx, args.pub, PubFormat(args));
+    const bool okPriv = ensure_parent_dirs(args.priv) && write_private_key(ctx, args.priv);
+    std::cout << sigStatusName(okPub ? SigStatus::Ok : SigStatus::WriteError) << '\t' << args.pub << '\n';
+    std::cout << sigStatusName(okPriv ? SigStatus::Ok : SigStatus::WriteError) << '\t' << args.priv << '\n';
+    PrintFingerprint(args, ctx);
+    return okPub && okPriv ? 0 : 1;
+  }
+
+  // перезапись открытого ключа в другом формате (текст <-> двоичный)
+  int RunPubkey(const CliArgs &args, VerifierContext &ctx) {
+    if (args.pub.empty() || args.out.empty()) {
+      std::cerr << "pubkey: нужны --pub и -o\n";
+      return 2;
+    }
+    if (!CheckPubFormat(args, ctx.params)) return 2;
+    if (!LoadPublicKey(ctx, args.pub)) return 2;
+    const bool ok = ensure_parent_dirs(args.out) && WritePublicKey(ctx, args.out, PubFormat(args));
+    std::cout << sigStatusName(ok ? SigStatus::Ok : SigStatus::WriteError) << '\t' << args.out << '\n';
+    PrintFingerprint(args, ctx);
+    return ok ? 0 : 1;
+  }
+
+  void PrintReport(const CliArgs &args, const BatchReport &rep) {
+    for (size_t i = 0; i < args.files.size(); ++i)
+      std::cout << sigStatusName(rep.status[i]) << '\t' << args.files[i] << '\n';
+    std::cout.flush();
+    std::cerr << args.command << ": files=" << args.files.size() << " ok=" << rep.ok
+        << " failed=" << (args.files.size() - rep.ok) << " seconds=" << rep.seconds
+        << " files_per_sec=" << rep.filesPerSecond() << "\n";
+  }
+
+  int RunBatch(const CliArgs &args, const std::function<SigStatus(const std::string &)> &op) {
+    if (args.files.empty()) {
+      std::cerr << args.command << ": не указаны файлы\n";
+      return 2;
+    }
+    const BatchReport rep = runBatch(args.files, args.threads, op);
+    PrintReport(args, rep);
+    return rep.ok == args.files.size() ? 0 : 1;
+  }
+}
+
+int main(int argc, char **argv) {
+  std::ios::sync_with_stdio(false);
+
+  CliArgs args;
+  if (!ParseArgs(argc, argv, args)) {
+    PrintUsage();
+    return 2;
+  }
+  SignerContext ctx; // для verify/extract используется только часть VerifierContext
+  if (!LoadParameters(args.params, ctx.params)) return 2;
+#ifndef FLAG_BENCH
+  if (args.seeded && args.command != "keygen") {
+    std::cerr << args.command << ": --seed допустим только для keygen\n";
+    return 2;
+  }
+#endif
+  if (args.seeded) drbgSeed(args.seed);
+
+  if (args.command == "keygen") return RunKeygen(args, ctx);
+
+  if (args.command == "pubkey") return RunPubkey(args, ctx);
+
+  if (args.command == "sign") {
+    if (args.priv.empty()) {
+      std::cerr << "sign: нужен закрытый ключ (-k)\n";
+      return 2;
+    }
+    if (!read_private_key(ctx, args.priv)) return 2;
+    const SignedFormat format = args.detached ? SignedFormat::Detached : SignedFormat::Embedded;
+    const SigEncoding encoding = args.compact ? SigEncoding::Compact : SigEncoding::Raw;
+    if (args.presign > 0) {
+      PresignPool pool(ctx, args.presign);
+      const int rc = RunBatch(args, [&pool, format, encoding](const std::string &path) {
+        return signFile(pool, path, format, encoding);
+      });
+      const PresignStats st = pool.stats();
+      std::cerr << "presign: pool=" << pool.capacity() << " produced=" << st.produced << " from_pool=" << st.fromPool
+          << " empty=" << st.empty << " empty_rate=" << st.emptyRate() << "\n";
+      return rc;
+    }
+    const unsigned signThreads = args.signThreads;
+    return RunBatch(args, [&ctx, signThreads, format, encoding](const std::string &path) {
+      return signFile(ctx, path, signThreads, format, encoding);
+    });
+  }
+
+  if (args.command == "verify") {
+    if (args.pub.empty()) {
+      std::cerr << "verify: нужен открытый ключ (--pub)\n";
+      return 2;
+    }
+    if (!LoadPublicKey(ctx, args.pub)) return 2;
+    if (args.files.empty()) {
+      std::cerr << "verify: не указаны файлы\n";
+      return 2;
+    }
+    const BatchReport rep = verifyBatch(ctx, args.files, args.threads);
+    PrintReport(args, rep);
+    return rep.ok == args.files.size() ? 0 : 1;
+  }
+
+  if (args.command == "extract") {
+    return RunBatch(args, [&ctx](const std::string &path) {
+      std::string outPath;
+      return extractMessage(ctx.params, path, outPath);
+    });
+  }
+
+  PrintUsage();
+  return 2;
+}
@@ -4,17 +4,34 @@
 
 #pragma once
 
+#include <span>
+
 #include "common.hpp"
 
-static int modQ(long long x);
+// MACC из ALPHA, SIG_BOUND2 и таблица ядер для (N, Q); вызывать после заполнения P
+void prepareParams(Params &P);
+
+int modQ(const Params &P, long long x);
+
+int center(const Params &P, int a);
+
+// center для Q = 2^k: v берётся по модулю 2^16 (ленивое приведение), без ветвлений
+inline int centerPow2(const uint16_t v, const int q) {
+  const int x = v & (q - 1);
+  return x - (q & -static_cast<int>(x > q / 2));
+}
+
+Poly zeroPoly(const Params &P);
 
-static int center(int a);
+// subMod и mulModQ идут через таблицу ядер P.kernels (kernels.hpp);
+// варианты со span пишут в R (длины N) без выделения памяти
+Poly subMod(const Params &P, const Poly &A, const Poly &B);
 
-static Poly zeroPoly();
+void subMod(const Params &P, std::span<const int> A, std::span<const int> B, std::span<int> R);
 
-static Poly subMod(const Poly &A, const Poly &B);
+Poly mulModQ(const Params &P, const Poly &A, const Poly &B);
 
-static Poly mulModQ(const Poly &A, const Poly &B);
+void mulModQ(const Params &P, std::span<const int> A, std::span<const int> B, std::span<int> R);
 
 // умножение по модулю 2^t (для Хензеля)
-static Poly mulModPow2(const Poly &A, const Poly &B, int M);
+Poly mulModPow2(const Params &P, const Poly &A, const Poly &B, int M);
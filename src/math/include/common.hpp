@@ -4,10 +4,12 @@
 
 #pragma once
 
+#include <cstdint>
 #include <vector>
 
 using Poly = std::vector<int>;
 using PolyLL = std::vector<long long>;
+using Poly16 = std::vector<uint16_t>; // коэффициенты по модулю 2^16 (путь Q = 2^k)
 
 struct EHash {
   Poly e_small;
@@ -18,13 +20,22 @@ struct Signature {
   Poly x1, x2, e;
 };
 
-static int G_N = 0; // степень кольца
-static int G_Q = 0; // модуль по коэффициентам
-static int G_D = 0; // вес тернарных ключей
-static double G_NU = 0; // коэффициент в норме NTRUSign_once
-static int G_NORM_BOUND = 0; // порог нормы для s,t
-static double G_ETA = 0; // коэффициент для bound подписи
-static int G_ALPHA = 0; // альфа (размер малых e)
-static int G_SIGMA = 0; // стд. отклонение Гаусса
-static double G_MACC = 0; // нормировочный коэффициент для rejection
-static int G_MAX_SIGN_ATT = 1000; // потолок попыток маскирования
+struct RingKernels;
+
+// Параметры схемы (ключи файла параметров). Заполняются вызывающим кодом,
+// затем prepareParams (arithmetic.hpp) вычисляет MACC, SIG_BOUND2 и выбирает ядра.
+struct Params {
+  int N = 0; // степень кольца
+  int Q = 0; // модуль по коэффициентам
+  int D = 0; // вес тернарных ключей
+  double NU = 0; // коэффициент в норме NTRUSign_once
+  int NORM_BOUND = 0; // порог нормы для s,t
+  double ETA = 0; // коэффициент для bound подписи
+  int ALPHA = 0; // альфа (размер малых e)
+  int SIGMA = 0; // стд. отклонение Гаусса
+  double MACC = 0; // нормировочный коэффициент для rejection
+  int MAX_SIGN_ATT = 1000; // потолок попыток маскирования
+  int64_t SIG_BOUND2 = 0; // наибольшее целое ||x||^2 подписи в пределах ETA*SIGMA*sqrt(2N)
+  bool pow2 = false; // Q = 2^k <= 2^16: коэффициенты в uint16 (Pow2Ring в ntru.cpp)
+  const RingKernels *kernels = nullptr; // таблица ядер для (N, Q)
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// ГПСЧ на ChaCha20 (вариант Бернштейна: 64-битный счётчик блоков и 64-битный номер потока).
+// Выход генерируется сразу блоками по 1 КиБ и раздаётся 64-битными словами.
+class ChaChaDrbg {
+public:
+  using result_type = uint64_t;
+
+  using Key = std::array<uint32_t, 8>;
+
+  static constexpr result_type min() { return 0; }
+
+  static constexpr result_type max() { return UINT64_MAX; }
+
+  ChaChaDrbg(const Key &key, uint64_t stream, uint64_t counter = 0);
+
+  result_type operator()() {
+    if (pos_ == BUF_WORDS) refill();
+    return buf_[pos_++];
+  }
+
+  void fill(uint8_t *out, size_t len);
+
+  // ключ для дочернего генератора (256 бит из текущего потока)
+  Key deriveKey();
+
+private:
+  static constexpr size_t BLOCKS = 16;
+  static constexpr size_t BUF_WORDS = BLOCKS * 8;
+
+  void refill();
+
+  Key key_;
+  uint64_t stream_;
+  uint64_t counter_;
+  size_t pos_ = BUF_WORDS;
+  alignas(64) uint64_t buf_[BUF_WORDS];
+};
+
+// Режим генераторов math_ntru. По умолчанию ключ каждого потока берётся из энтропии ОС.
+// drbgSeed включает детерминированный режим: все потоки выводятся из seed
+// (поток, первым обратившийся к threadDrbg, получает номер 0 и т.д.), так что
+// однопоточный прогон подписи/генерации ключей воспроизводится точно.
+void drbgSeed(uint64_t seed);
+
+void drbgSeedFromEntropy();
+
+bool drbgDeterministic();
+
+// буферизованный генератор текущего потока; пересоздаётся после смены режима
+ChaChaDrbg &threadDrbg();
@@ -4,13 +4,62 @@
 
 #pragma once
 
-#include <random>
-
-static int sample_gauss_int(std::mt19937 &rng, const double sigma) {
-  std::normal_distribution<double> norm01(0.0, 1.0);
-  const double x = norm01(rng) * sigma;
-  long long y = llround(x);
-  if (y > (1ll << 31) - 1) y = (1ll << 31) - 1;
-  if (y < -(1ll << 31)) y = -(1ll << 31);
-  return static_cast<int>(y);
-}
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Табличный (CDT) сэмплер целочисленного Гаусса -- округлённое нормальное распределение:
+// P(k) = Ф((k+1/2)/sigma) - Ф((k-1/2)/sigma).
+// На отсчёт -- одно 64-битное случайное слово: старший бит -- знак, остальные 63 --
+// равномерное u, по которому |k| ищется в таблице хвостов через индекс-путеводитель.
+class DiscreteGaussCDT {
+public:
+  explicit DiscreteGaussCDT(double sigma);
+
+  double sigma() const { return sigma_; }
+
+  template<class URBG>
+  int sample(URBG &rng) const { return fromBits(next64(rng)); }
+
+  // out[0..n) -- независимые отсчёты
+  template<class URBG>
+  void fill(URBG &rng, int *out, const size_t n) const {
+    for (size_t i = 0; i < n; ++i) out[i] = fromBits(next64(rng));
+  }
+
+private:
+  static constexpr int GUIDE_BITS = 12;
+  static constexpr int GUIDE_SHIFT = 63 - GUIDE_BITS;
+
+  template<class URBG>
+  static uint64_t next64(URBG &rng) {
+    if constexpr (URBG::max() - URBG::min() == UINT64_MAX) {
+      return static_cast<uint64_t>(rng() - URBG::min());
+    } else {
+      static_assert(URBG::max() - URBG::min() == UINT32_MAX, "нужен 32- или 64-битный генератор");
+      const uint64_t hi = static_cast<uint32_t>(rng() - URBG::min());
+      return (hi << 32) | static_cast<uint32_t>(rng() - URBG::min());
+    }
+  }
+
+  int fromBits(const uint64_t bits) const {
+    const uint64_t u = bits & (UINT64_MAX >> 1);
+    // |k| -- первый j с tail_[j] <= u; по путеводителю j лежит в [guide_[b+1], guide_[b]]
+    const size_t b = static_cast<size_t>(u >> GUIDE_SHIFT);
+    size_t lo = guide_[b + 1], hi = guide_[b];
+    while (lo < hi) {
+      const size_t mid = (lo + hi) / 2;
+      if (tail_[mid] <= u) hi = mid;
+      else lo = mid + 1;
+    }
+    const int mag = static_cast<int>(lo);
+    return (bits >> 63) ? -mag : mag;
+  }
+
+  double sigma_;
+  std::vector<uint64_t> tail_; // tail_[j] = 2^63 * P(|k| > j), убывает до 0
+  std::vector<uint32_t> guide_; // guide_[b] = |k| для u = b << GUIDE_SHIFT
+};
+
+// таблица для данного sigma строится один раз и переиспользуется всеми потоками
+const DiscreteGaussCDT &gaussCDT(double sigma);
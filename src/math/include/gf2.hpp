@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+#include "common.hpp"
+
+// GF(2) многочлены, упакованные по 64 коэффициента в слово:
+// бит (i % 64) слова w[i / 64] -- коэффициент при X^i.
+struct Poly2W {
+  std::vector<uint64_t> w;
+
+  Poly2W() = default;
+
+  // место под коэффициенты степени до cap включительно (+ слово запаса под сдвиги)
+  explicit Poly2W(const int cap) { w.assign(cap / 64 + 2, 0); }
+
+  int bit(const int i) const { return static_cast<int>((w[i >> 6] >> (i & 63)) & 1u); }
+
+  void flip(const int i) { w[i >> 6] ^= uint64_t{1} << (i & 63); }
+};
+
+// степень, -1 для нуля; поиск ведётся вниз начиная с from
+int deg2w(const Poly2W &p, int from);
+
+int deg2w(const Poly2W &p);
+
+// A ^= B << k, где degB -- степень B; A должен вмещать степень degB + k
+void addShifted2w(Poly2W &A, const Poly2W &B, int degB, int k);
+
+// инверсия f mod 2 по модулю X^n + 1 без выделений памяти внутри цикла Евклида
+bool invertMod2W(const Poly &f, int n, Poly &inv2_out);
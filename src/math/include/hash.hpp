@@ -3,9 +3,39 @@
 //
 
 #pragma once
+#include <cstddef>
 #include <cstdint>
+#include <span>
 #include <vector>
 
 #include "common.hpp"
 
-static EHash H_e_small(const Poly &z_modq, const std::vector<uint8_t> &msg);
+// Состояние хэша после поглощения сообщения. Размер O(N) и не зависит от длины
+// сообщения: сообщение поглощается один раз, а e для каждого z дополучается за O(N).
+struct HashState {
+  uint32_t s1 = 0x243F6A88u;
+  uint32_t s2 = 0x85A308D3u;
+  Poly e_small;
+};
+
+HashState H_init(const Params &P);
+
+// сброс st к начальному состоянию; память st переиспользуется
+void H_init(const Params &P, HashState &st);
+
+// можно вызывать по частям -- результат как у одного вызова на всём сообщении
+void H_absorb(const Params &P, HashState &st, const uint8_t *data, size_t len);
+
+HashState H_absorb_msg(const Params &P, const std::vector<uint8_t> &msg);
+
+// дописывает z к поглощённому сообщению, st не меняется
+EHash H_finish(const Params &P, const HashState &st, const Poly &z_modq);
+
+// то же в буферы вызывающего длины N, без выделения памяти; z в int или uint16 (уже в [0, Q))
+void H_finish(const Params &P, const HashState &st, std::span<const int> z_modq, std::span<int> e_small, std::span<int> e_mod);
+
+void H_finish(const Params &P, const HashState &st, std::span<const uint16_t> z_modq, std::span<int> e_small,
+              std::span<int> e_mod);
+
+// H(msg || z) целиком, эквивалентно H_finish(P, H_absorb_msg(P, msg), z)
+EHash H_e_small(const Params &P, const Poly &z_modq, const std::vector<uint8_t> &msg);
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "common.hpp"
+#include "multiplication.hpp"
+#include "params.hpp"
+#include "sparse.hpp"
+
+// Таблица ядер кольца Z_Q[X]/(X^N - 1), по которой идут горячие операции подписи
+// и проверки. Для наборов из PARAM_SETS ядра инстанцированы с N, Q как
+// константами: uint16-ядра (Q = 2^k) -- Карацуба фиксированной длины, в int-ядрах
+// произведение считает общий движок (chooseMulMethod), константой становится только
+// приведение (% Q -> маска); для прочих наборов -- общий путь по P.N, P.Q.
+// Ядра пишут в буферы вызывающего (длины N) и не выделяют память в куче.
+// Аргумент n у разреженных ядер сохранён ради общего пути, специализации его не читают.
+struct RingKernels {
+  const ParamSet *set; // nullptr -- общий путь
+  void (*mulModQ)(const Params &P, std::span<const int> A, std::span<const int> B, std::span<int> R);
+  void (*subMod)(const Params &P, std::span<const int> A, std::span<const int> B, std::span<int> R);
+  // только для Q = 2^k <= 2^16: r = a * b по модулю 2^16, маска Q-1 -- на стороне вызывающего
+  void (*mulPow2)(const Params &P, std::span<const uint16_t> a, std::span<const uint16_t> b, std::span<uint16_t> r);
+  // те же произведения на подготовленный операнд (prepareOperand / prepareOperand16)
+  void (*mulPreparedModQ)(const Params &P, std::span<const int> a, const PreparedOperand<long long> &b, std::span<int> r);
+  void (*mulPreparedPow2)(const Params &P, std::span<const uint16_t> a, const PreparedOperand<uint16_t> &b,
+                          std::span<uint16_t> r);
+  void (*mulSparseAcc)(const int *a, const SparseTernary &t, int n, long long *acc);
+  void (*mulSparsePair)(const int *a, const SparseTernary &f, const SparseTernary &g, int n, long long *af, long long *ag);
+};
+
+void mulModQGeneric(const Params &P, std::span<const int> A, std::span<const int> B, std::span<int> R);
+
+void subModGeneric(const Params &P, std::span<const int> A, std::span<const int> B, std::span<int> R);
+
+void mulPow2Generic(const Params &P, std::span<const uint16_t> a, std::span<const uint16_t> b, std::span<uint16_t> r);
+
+void mulPreparedModQGeneric(const Params &P, std::span<const int> a, const PreparedOperand<long long> &b, std::span<int> r);
+
+void mulPreparedPow2Generic(const Params &P, std::span<const uint16_t> a, const PreparedOperand<uint16_t> &b,
+                            std::span<uint16_t> r);
+
+inline constexpr RingKernels GENERIC_KERNELS{nullptr, &mulModQGeneric, &subModGeneric, &mulPow2Generic,
+                                             &mulPreparedModQGeneric, &mulPreparedPow2Generic, &mulSparseAcc,
+                                             &mulSparsePair};
+
+// специализация для (n, q) или GENERIC_KERNELS
+const RingKernels &selectKernels(int n, int q);
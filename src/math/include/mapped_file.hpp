@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Файл, отображённый в память только для чтения (mmap). Содержимое доступно окном
+// bytes() без копирования, пока объект жив. Без mmap (Windows) файл читается в буфер
+// объекта -- интерфейс тот же.
+class MappedFile {
+public:
+  MappedFile() = default;
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  // false -- файл не открылся или не отобразился; прежнее отображение снимается
+  bool open(const std::string &path);
+
+  void close();
+
+  std::span<const uint8_t> bytes() const { return {data_, size_}; }
+
+private:
+  const uint8_t *data_ = nullptr;
+  size_t size_ = 0;
+  bool mapped_ = false;
+  std::vector<uint8_t> fallback_;
+};
+
+// Копирует len байт src, начиная с offset, в новый файл dst. На Linux данные идут
+// через copy_file_range (или sendfile) и не проходят через память процесса.
+bool copy_file_part(const std::string &src, uint64_t offset, uint64_t len, const std::string &dst);
+
+// Записывает bytes в path с правами 0600 (только владелец): файл создаётся сразу с ними,
+// у существующего права сужаются до записи. Для закрытого ключа. На Windows -- обычная запись.
+bool write_private_file(const std::string &path, std::span<const uint8_t> bytes);
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "common.hpp"
+
+// Движок умножения в кольце Z[X]/(X^N - 1).
+// Все методы считают точное целочисленное произведение (в long long),
+// поэтому после приведения по модулю результат совпадает со школьным.
+
+enum class MulMethod {
+  Schoolbook, // O(N^2)
+  Karatsuba, // O(N^1.58)
+  Toom4 // Тоом-Кук 4, точечные произведения через Карацубу
+};
+
+// пороги переключения методов (подобраны по bench_mul)
+constexpr int KARATSUBA_BASE = 32; // ниже -- школьный метод внутри рекурсии
+constexpr int MUL_KARATSUBA_FROM = 32; // с какого N выбирать Карацубу
+constexpr int MUL_TOOM4_FROM = 160; // с какого N выбирать Тоом-4
+
+constexpr MulMethod chooseMulMethod(const int n) {
+  if (n >= MUL_TOOM4_FROM) return MulMethod::Toom4;
+  if (n >= MUL_KARATSUBA_FROM) return MulMethod::Karatsuba;
+  return MulMethod::Schoolbook;
+}
+
+const char *mulMethodName(MulMethod method);
+
+// Число элементов дерева подготовленного операнда Карацубы длины n: внутренний узел
+// хранит только детей (младшая половина, старшая, сумма половин), лист -- сам операнд.
+// Разбиение то же, что у рекурсии Карацубы: m = (n + 1) / 2 младших коэффициентов.
+constexpr size_t karatsubaTreeSize(const int n) {
+  if (n <= KARATSUBA_BASE) return static_cast<size_t>(n);
+  const int m = (n + 1) / 2;
+  return 2 * karatsubaTreeSize(m) + karatsubaTreeSize(n - m);
+}
+
+// Операнд, подготовленный для многих умножений на него (открытый ключ h): для Карацубы --
+// дерево с заранее посчитанными суммами половин всех узлов рекурсии, для Тоома-4 -- значения
+// в 7 точках. Умножение платит только за свой операнд; результат точно совпадает с обычным.
+template<typename T>
+struct PreparedOperand {
+  int n = 0; // 0 -- не подготовлен
+  MulMethod method = MulMethod::Schoolbook;
+  std::vector<T> tree;
+};
+
+void prepareOperand(const int *B, int n, MulMethod method, PreparedOperand<long long> &out);
+
+// для mulCyclic16 и пакетных произведений: только школьный метод и Карацуба
+void prepareOperand16(const uint16_t *b, int n, PreparedOperand<uint16_t> &out);
+
+void prepareOperand32(const uint32_t *b, int n, PreparedOperand<uint32_t> &out);
+
+// Варианты с указателями пишут в буфер вызывающего, временная память -- из threadArena().
+
+// точное циклическое произведение: acc[k] = sum_{i+j = k mod n} A[i]*B[j]
+PolyLL mulCyclic(const Poly &A, const Poly &B, int n, MulMethod method);
+
+void mulCyclicAcc(const int *A, const int *B, int n, MulMethod method, long long *acc);
+
+// циклическое произведение с приведением коэффициентов в [0, q)
+Poly mulCyclicModQ(const Poly &A, const Poly &B, int n, int q, MulMethod method);
+
+void mulCyclicModQ(const int *A, const int *B, int n, int q, MulMethod method, int *R);
+
+void mulCyclicAccPrepared(const int *A, const PreparedOperand<long long> &B, long long *acc);
+
+void mulCyclicModQPrepared(const int *A, const PreparedOperand<long long> &B, int q, int *R);
+
+// циклическое произведение по модулю 2^16 (переполнение uint16 -- приведение); для
+// Q = 2^k <= 2^16 результат совпадает с mulCyclicModQ после маски Q-1.
+// Тоом-4 делит на 2 и 3 и по модулю 2^16 не работает, поэтому только школьный и Карацуба.
+void mulCyclic16(const uint16_t *a, const uint16_t *b, int n, uint16_t *r);
+
+void mulCyclic16Prepared(const uint16_t *a, const PreparedOperand<uint16_t> &b, uint16_t *r);
+
+// Пачка из MUL_BATCH_LANES циклических произведений на общий подготовленный операнд b.
+// x и r -- чередующаяся раскладка: x[i * MUL_BATCH_LANES + l] -- коэффициент i l-го
+// сомножителя. Рекурсия Карацубы идёт по b, а самые внутренние циклы -- по сомножителям
+// (SIMD-полосы), так что лист b читается один раз на всю пачку.
+// Арифметика по модулю 2^16 (uint16) или 2^32 (uint32).
+constexpr int MUL_BATCH_LANES = 16;
+
+void mulCyclic16Batch(const uint16_t *x, const PreparedOperand<uint16_t> &b, uint16_t *r);
+
+void mulCyclic32Batch(const uint32_t *x, const PreparedOperand<uint32_t> &b, uint32_t *r);
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "common.hpp"
+
+// Компактное кодирование подписи (хвост форматов SGN2/SIG2, см. ntru.hpp). Поток битов
+// от младшего к старшему:
+//   k1, k2 -- по байту: параметры Райса для x1 и x2;
+//   e -- N значений e + ALPHA по ceil(log2(2*ALPHA + 1)) бит;
+//   x1, x2 -- центрированные коэффициенты, зигзаг (0, -1, 1, -2, ... -> 0, 1, 2, 3, ...)
+//   и код Голомба-Райса: u >> k единицами с завершающим нулём, затем младшие k бит u;
+//   нули до границы байта.
+// k выбирается по каждому многочлену как дающий наименьшую длину. При x ~ Гаусс(SIGMA)
+// коэффициент занимает около log2(SIGMA) + 2 бит вместо 16.
+
+// наибольший размер закодированной подписи с запасом, нужным кодировщику
+size_t compact_signature_bound(const Params &P);
+
+// out -- не меньше compact_signature_bound; возвращает число записанных байт или 0, если
+// S не представима (e вне [-ALPHA, ALPHA] по модулю Q, коэффициент x вне [0, Q))
+size_t encode_compact(const Params &P, const Signature &S, std::span<uint8_t> out);
+
+// false -- данные повреждены: обрыв, значение вне диапазона, лишние байты или биты
+bool decode_compact(const Params &P, std::span<const uint8_t> in, Signature &S);
@@ -4,10 +4,76 @@
 
 #pragma once
 
+#include <cstdint>
+#include <span>
+#include <string>
+
 #include "common.hpp"
+#include "multiplication.hpp"
+#include "sparse.hpp"
+
+// Контексты владеют параметрами и ключами. Функции схемы получают контекст явно и
+// только читают его, поэтому в одном процессе можно параллельно подписывать и
+// проверять разными ключами и наборами параметров без блокировок.
+// h в форме, подготовленной для умножения (multiplication.hpp): h*x при проверке и
+// h*y1, s*h при подписи платят только за свой сомножитель. Заполняется одна из форм --
+// по пути арифметики (Params::pow2).
+struct PreparedPublicKey {
+  PreparedOperand<long long> wide; // Q != 2^k
+  PreparedOperand<uint16_t> narrow; // Q = 2^k
+};
+
+struct VerifierContext {
+  Params params;
+  Poly h; // открытый ключ
+  Poly16 h16; // h в uint16 для пути Q = 2^k (заполняет expandPublicKey)
+  PreparedPublicKey hp; // заполняет expandPublicKey
+};
+
+struct SignerContext : VerifierContext {
+  Poly F, G;
+  SparseTernary Fsparse, Gsparse; // развёрнутый ключ: F, G в виде списков индексов
+};
+
+// производные формы h (h16, hp); вызывается после каждой записи ctx.h
+void expandPublicKey(VerifierContext &ctx);
+
+// Развёрнутый закрытый ключ -- F, G в форме, с которой работают ядра подписи.
+// Строится один раз при генерации или загрузке ключа, попытки подписи его только читают.
+// false -- F или G не тернарные
+bool expandPrivateKey(SignerContext &ctx);
+
+void genTernary(const Params &P, Poly &a);
+
+// новые F, G, h в ctx; ctx.params должны быть заполнены (prepareParams)
+bool keygen(SignerContext &ctx);
+
+// двоичные форматы ключей хранят коэффициенты в uint16
+constexpr int KEY_MAX_Q = 65536;
+
+// Закрытый ключ: "NSK1", uint32 N, uint32 Q, затем F, G, h по N значений uint16.
+// Формат фиксированной длины, читается одним read без разбора текста. Файл создаётся с
+// правами 0600; при Q > KEY_MAX_Q запись и чтение отказывают, коэффициенты вне [0, Q) --
+// повреждение.
+bool write_private_key(const SignerContext &ctx, const std::string &path);
+
+// загружает F, G, h (и их разреженные формы); N и Q должны совпадать с ctx.params
+bool read_private_key(SignerContext &ctx, const std::string &path);
+
+// Открытый ключ: "NPK1", uint32 N, uint32 Q, uint32 номер набора параметров (ParamSet::id,
+// 0 -- набор вне PARAM_SETS), uint64 отпечаток, затем h -- N значений uint16. Файл
+// отображается в память и разбирается на месте, без разбора текста. Текстовый формат
+// (N и коэффициенты через пробел) остаётся для обмена -- см. LoadPublicKey в operations.hpp.
+// Запись без сообщений (их печатает вызывающий), чтение сообщает об ошибке в stderr.
+// При Q > KEY_MAX_Q запись и чтение отказывают (такой ключ пишется только текстом).
+bool write_public_key(const VerifierContext &ctx, const std::string &path);
 
-static Poly G_Fkey, G_Gkey, G_Hpub;
+// N, Q и набор должны совпадать с ctx.params, отпечаток -- с содержимым файла
+bool read_public_key(VerifierContext &ctx, const std::string &path);
 
-static void genTernary(Poly &a);
+// true -- bytes начинаются с магии двоичного открытого ключа
+bool is_binary_public_key(std::span<const uint8_t> bytes);
 
-static bool keygen();
+// FNV-1a (64 бита) по N, Q и коэффициентам h в uint16, как они лежат в файле. Опознаёт
+// ключ и ловит повреждение файла; криптографической стойкости не даёт. Только при Q <= KEY_MAX_Q.
+uint64_t public_key_fingerprint(const Params &P, const Poly &h);
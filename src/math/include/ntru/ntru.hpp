@@ -4,15 +4,142 @@
 
 #pragma once
 
-#include <fstream>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
 
 #include "common.hpp"
+#include "drbg.hpp"
 #include "hash.hpp"
+#include "ntru/keys.hpp"
 
-static bool NTRUSign_once(const Poly &m, Poly &s_out);
+// Итог операций с подписанными файлами. Сами функции ничего не печатают:
+// текст для меню даёт вызывающий код, для CLI печатается sigStatusName.
+enum class SigStatus {
+  Ok,
+  OpenError, // не удалось открыть входной файл
+  WriteError, // не удалось создать/записать выходной файл
+  BadMagic, // не подписанный файл
+  LengthMismatch, // размер не совпадает с заголовком
+  SignFailed, // rejection sampling исчерпал попытки
+  OrigMissing, // исходный файл отсутствует
+  Modified, // время изменения исходного файла не совпадает
+  HashMismatch,
+  Norm
+};
 
-static bool sign_strict(const std::vector<uint8_t> &msg, Signature &sig);
+// короткое машинно-читаемое имя: "ok", "hash_mismatch", ...
+const char *sigStatusName(SigStatus s);
 
-static bool write_signed(const std::string &inPath, const std::vector<uint8_t> &msg, const Signature &S);
+// s -- короткий вектор решётки для m, t = s*h - m (центрированный); оба нужны
+// попытке подписи дальше, поэтому возвращаются, а не пересчитываются
+bool NTRUSign_once(const SignerContext &ctx, const Poly &m, Poly &s_out, Poly &t_out);
 
-static bool read_signed(const std::string &path, std::vector<uint8_t> &msg, Signature &S, uint64_t &L, int64_t &ts);
+bool sign_strict(const SignerContext &ctx, const std::vector<uint8_t> &msg, Signature &sig);
+
+// то же по уже поглощённому сообщению (H_absorb, в том числе по частям)
+bool sign_strict(const SignerContext &ctx, const HashState &msgHash, Signature &sig);
+
+// Подпись многих сообщений одним ключом (sigs -- размером msgs): циклы отбора
+// MUL_BATCH_LANES сообщений идут вместе, умножения на h -- пакетные. Бит i -- подпись
+// msgs[i] принята; при одном состоянии генератора (drbgSeed) подписи те же, что у
+// sign_strict, вызванного по очереди для каждого сообщения.
+std::vector<bool> sign_batch(const SignerContext &ctx, std::span<const std::vector<uint8_t>> msgs,
+                             std::span<Signature> sigs);
+
+// состояние хэша после поглощения msg; живёт в памяти потока до следующего вызова в нём
+const HashState &hash_message(const Params &P, const std::vector<uint8_t> &msg);
+
+const HashState &hash_message(const Params &P, std::span<const uint8_t> msg);
+
+// Не зависящая от сообщения часть попытки подписи: отсчёты y1, y2, z = y2 - h*y1 в [0, Q)
+// и монета отбора u. Маска одноразовая: две подписи с одной маской раскрывают ключ.
+struct SignMask {
+  Poly y1, y2, z;
+  double u = 0;
+};
+
+// офлайн-фаза; при одном rng маска та же, что у попытки sign_strict
+void sign_mask(const SignerContext &ctx, ChaChaDrbg &rng, SignMask &mask);
+
+// онлайн-фаза: хэш, шаг с лазейкой и отбор; true -- подпись принята
+bool sign_with_mask(const SignerContext &ctx, const HashState &msgHash, const SignMask &mask, Signature &sig);
+
+// те же попытки, но по threads штук одновременно (у каждой попытки свой поток ChaCha20);
+// возвращается принятая попытка с наименьшим номером -- распределение как у sign_strict
+bool sign_parallel(const SignerContext &ctx, const std::vector<uint8_t> &msg, Signature &sig, unsigned threads);
+
+bool sign_parallel(const SignerContext &ctx, const HashState &msgHash, Signature &sig, unsigned threads);
+
+// Ok, HashMismatch или Norm
+SigStatus verify_signature(const VerifierContext &ctx, const std::vector<uint8_t> &msg, const Signature &S);
+
+// то же по уже поглощённому сообщению (например, прямо из отображения файла)
+SigStatus verify_signature(const VerifierContext &ctx, const HashState &msgHash, const Signature &S);
+
+// Проверка многих подписей одним ключом (msgs[i] -- сообщение sigs[i]): произведения h*x1
+// считаются пачками по MUL_BATCH_LANES, лист h читается один раз на пачку. Итог i-й подписи
+// тот же, что у verify_signature; бит i -- Ok, status (если передан, размером sigs) --
+// подробный итог.
+std::vector<bool> verify_batch(const VerifierContext &ctx, std::span<const std::vector<uint8_t>> msgs,
+                               std::span<const Signature> sigs, std::span<SigStatus> status = {});
+
+// hashes[i] -- поглощённое сообщение sigs[i]
+std::vector<bool> verify_batch(const VerifierContext &ctx, std::span<const HashState> hashes,
+                               std::span<const Signature> sigs, std::span<SigStatus> status = {});
+
+// Формат SGN1: "SGN1", L (uint64), ts (int64), L байт сообщения, x1, x2, e (по N uint16).
+// write_signed пишет inPath + ".signed" целиком; заголовок и хвост с подписью доступны
+// отдельно для потоковой записи.
+// Отсоединённая подпись SIG1 (файл ".sig" рядом с исходником): "SIG1", L, ts, x1, x2, e --
+// без копии сообщения. Сообщение привязано самой подписью (e = H(msg || z)), L и ts --
+// длина и время изменения исходника на момент подписи.
+// SGN2 и SIG2 -- те же контейнеры с компактной подписью (codec.hpp) вместо 3N uint16;
+// её длина -- остаток файла.
+enum class SignedFormat {
+  Embedded, // SGN1/SGN2, <file>.signed
+  Detached // SIG1/SIG2, <file>.sig
+};
+
+enum class SigEncoding {
+  Raw, // x1, x2, e по N uint16
+  Compact // e упакован, x1 и x2 -- код Голомба-Райса (encode_compact)
+};
+
+SigStatus write_signed(const Params &P, const std::string &inPath, const std::vector<uint8_t> &msg, const Signature &S,
+                       SigEncoding encoding = SigEncoding::Raw);
+
+void write_signed_header(std::ostream &out, SignedFormat format, SigEncoding encoding, uint64_t L, int64_t ts);
+
+// непредставимая в Compact подпись (см. encode_compact) ставит out в состояние ошибки
+void write_signature(const Params &P, std::ostream &out, const Signature &S, SigEncoding encoding = SigEncoding::Raw);
+
+// время изменения файла, как оно хранится в поле ts (0 -- недоступно)
+int64_t file_timestamp(const std::string &path);
+
+SigStatus read_signed(const Params &P, const std::string &path, std::vector<uint8_t> &msg, Signature &S, uint64_t &L, int64_t &ts);
+
+// Окна в содержимое .signed или .sig (обычно -- в MappedFile) без копирования. sig -- хвост
+// с подписью в кодировке encoding, без выравнивания; в Signature его раскладывает
+// decode_signature. У отсоединённой подписи msg пуст: сообщение -- исходный файл длины L.
+struct SignedView {
+  SignedFormat format = SignedFormat::Embedded;
+  SigEncoding encoding = SigEncoding::Raw;
+  uint64_t L = 0;
+  int64_t ts = 0;
+  std::span<const uint8_t> msg;
+  std::span<const uint8_t> sig;
+};
+
+// только заголовок встроенного формата (SGN1, SGN2): магия и L, не выходящая за файл
+// (хвост с подписью не проверяется)
+SigStatus parse_signed_header(std::span<const uint8_t> file, uint64_t &L, int64_t &ts);
+
+// формат и кодировка -- по магии; Ok, BadMagic или LengthMismatch (у Raw размер файла
+// должен точно соответствовать формату, L и N; Compact проверяет decode_signature)
+SigStatus parse_signed(const Params &P, std::span<const uint8_t> file, SignedView &view);
+
+// Ok или LengthMismatch (повреждённая компактная подпись)
+SigStatus decode_signature(const Params &P, const SignedView &view, Signature &S);
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "drbg.hpp"
+#include "ntru/ntru.hpp"
+
+// Офлайн/онлайн-подпись. Фоновые потоки заранее считают маски (SignMask: отсчёты y1, y2
+// и произведение z = y2 - h*y1) и держат их в пуле ограниченного размера; онлайн-вызов
+// sign только хэширует сообщение, делает шаг с лазейкой и отбор. Каждая маска отдаётся
+// ровно одной попытке. Если пул пуст, маска считается на месте и попытка учитывается
+// в PresignStats::empty.
+struct PresignStats {
+  uint64_t produced = 0; // масок посчитано в фоне
+  uint64_t fromPool = 0; // попыток с маской из пула
+  uint64_t empty = 0; // попыток, заставших пул пустым
+  uint64_t signatures = 0; // принятых подписей
+
+  double emptyRate() const {
+    const uint64_t attempts = fromPool + empty;
+    return attempts ? static_cast<double>(empty) / static_cast<double>(attempts) : 0.0;
+  }
+};
+
+class PresignPool {
+public:
+  // ctx читается фоновыми потоками и должен жить дольше пула без изменений
+  PresignPool(const SignerContext &ctx, size_t capacity, unsigned workers = 1);
+
+  ~PresignPool();
+
+  PresignPool(const PresignPool &) = delete;
+
+  PresignPool &operator=(const PresignPool &) = delete;
+
+  // как sign_strict, но маски попыток берутся из пула; можно звать из нескольких потоков
+  bool sign(const std::vector<uint8_t> &msg, Signature &sig);
+
+  bool sign(const HashState &msgHash, Signature &sig);
+
+  const SignerContext &context() const { return ctx_; }
+
+  size_t capacity() const { return slots_.size(); }
+
+  PresignStats stats() const;
+
+private:
+  void work();
+
+  // true -- маска из пула обменяна с mask
+  bool take(SignMask &mask);
+
+  // маска попытки k читает поток ChaCha20 с номером k под ключом пула
+  void produce(SignMask &mask);
+
+  const SignerContext &ctx_;
+  const ChaChaDrbg::Key key_;
+  std::atomic<uint64_t> nextStream_{0};
+
+  mutable std::mutex m_;
+  std::condition_variable notFull_;
+  std::vector<SignMask> slots_; // кольцо: готовые маски -- [head_, head_ + count_)
+  size_t head_ = 0;
+  size_t count_ = 0;
+  bool stop_ = false;
+  PresignStats stats_;
+  std::vector<std::thread> workers_;
+};
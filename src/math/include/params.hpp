@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+// Реестр поддерживаемых наборов параметров. Для каждого набора ядра кольца
+// (kernels.hpp) собираются с N и Q как константами компиляции; остальные N, Q
+// обрабатываются общим путём.
+struct ParamSet {
+  uint32_t id; // стабильный номер набора
+  const char *name;
+  int n;
+  int q;
+};
+
+inline constexpr ParamSet PARAM_SETS[] = {
+  {1, "ntru-251-2048", 251, 2048},
+  {2, "ntru-503-2048", 503, 2048},
+  {3, "ntru-743-2048", 743, 2048},
+};
+
+// nullptr, если для (n, q) нет специализации
+constexpr const ParamSet *findParamSet(const int n, const int q) {
+  for (const ParamSet &p: PARAM_SETS)
+    if (p.n == n && p.q == q) return &p;
+  return nullptr;
+}
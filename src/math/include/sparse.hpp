@@ -0,0 +1,65 @@
+#pragma once
+
+#include <algorithm>
+
+#include "common.hpp"
+
+// Тернарный многочлен (коэффициенты 0, ±1) в виде списков позиций +1 и -1.
+// Ключи F, G содержат всего D ненулевых коэффициентов, поэтому умножение
+// на них сводится к O(N*D) сложений/вычитаний сдвинутых копий.
+struct SparseTernary {
+  std::vector<int> plus;
+  std::vector<int> minus;
+};
+
+// a задан по модулю q (-1 хранится как q-1); false, если a не тернарный
+bool toSparseTernary(const Poly &a, int q, SparseTernary &out);
+
+// acc += a * t в Z[X]/(X^n - 1)
+void mulSparseAcc(const int *a, const SparseTernary &t, int n, long long *acc);
+
+// af += a * f, ag += a * g за один проход по a (блоками, a не вытесняется из кэша)
+void mulSparsePair(const int *a, const SparseTernary &f, const SparseTernary &g, int n, long long *af, long long *ag);
+
+// Те же ядра с длиной как параметром шаблона: N = 0 -- длина n во время выполнения (общий
+// путь выше), N > 0 -- константа, n не читается (специализированные ядра в kernels.cpp).
+namespace sparse_detail {
+  constexpr int SPARSE_BLOCK = 256;
+
+  // acc[(i + j) mod n] (+/-)= a[i] для i из [b0, b1)
+  template<int N, bool Add>
+  void rotateAcc(const int *a, const int j, const int n, const int b0, const int b1, long long *acc) {
+    const int len = N > 0 ? N : n;
+    const int split = std::min(std::max(len - j, b0), b1);
+    for (int i = b0; i < split; ++i) {
+      if constexpr (Add) acc[i + j] += a[i];
+      else acc[i + j] -= a[i];
+    }
+    for (int i = split; i < b1; ++i) {
+      if constexpr (Add) acc[i + j - len] += a[i];
+      else acc[i + j - len] -= a[i];
+    }
+  }
+
+  template<int N>
+  void applyBlock(const int *a, const SparseTernary &t, const int n, const int b0, const int b1, long long *acc) {
+    for (const int j: t.plus) rotateAcc<N, true>(a, j, n, b0, b1, acc);
+    for (const int j: t.minus) rotateAcc<N, false>(a, j, n, b0, b1, acc);
+  }
+}
+
+template<int N>
+void mulSparseAccN(const int *a, const SparseTernary &t, const int n, long long *acc) {
+  sparse_detail::applyBlock<N>(a, t, n, 0, N > 0 ? N : n, acc);
+}
+
+template<int N>
+void mulSparsePairN(const int *a, const SparseTernary &f, const SparseTernary &g, const int n, long long *af,
+                    long long *ag) {
+  const int len = N > 0 ? N : n;
+  for (int b0 = 0; b0 < len; b0 += sparse_detail::SPARSE_BLOCK) {
+    const int b1 = std::min(len, b0 + sparse_detail::SPARSE_BLOCK);
+    sparse_detail::applyBlock<N>(a, f, n, b0, b1, af);
+    sparse_detail::applyBlock<N>(a, g, n, b0, b1, ag);
+  }
+}
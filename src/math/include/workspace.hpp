@@ -0,0 +1,67 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// Рабочая память горячих путей подписи и проверки. Блоки по 64 байта выравнивания
+// выделяются при первом использовании и больше не освобождаются, поэтому после
+// прогрева подпись и проверка не обращаются к куче. Память выдаётся стеком:
+// Arena::Scope запоминает вершину и при выходе из области возвращает её обратно.
+class Arena {
+public:
+  static constexpr size_t ALIGN = 64;
+  static constexpr size_t BLOCK_BYTES = size_t{256} << 10;
+
+  class Scope {
+  public:
+    explicit Scope(Arena &arena) : arena_(arena), block_(arena.block_), offset_(arena.offset_) {}
+
+    ~Scope() {
+      arena_.block_ = block_;
+      arena_.offset_ = offset_;
+    }
+
+    Scope(const Scope &) = delete;
+
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    Arena &arena_;
+    size_t block_, offset_;
+  };
+
+  // count неинициализированных элементов; живут до конца текущего Scope
+  template<typename T>
+  std::span<T> alloc(const size_t count) {
+    static_assert(std::is_trivially_copyable_v<T> && alignof(T) <= ALIGN);
+    return {static_cast<T *>(raw(count * sizeof(T))), count};
+  }
+
+  // то же, заполненное нулями
+  template<typename T>
+  std::span<T> zeros(const size_t count) {
+    const std::span<T> s = alloc<T>(count);
+    std::fill(s.begin(), s.end(), T{});
+    return s;
+  }
+
+private:
+  struct Block {
+    std::unique_ptr<std::byte[]> mem; // с запасом ALIGN под выравнивание
+    std::byte *base;
+    size_t size;
+  };
+
+  void *raw(size_t bytes);
+
+  std::vector<Block> blocks_;
+  size_t block_ = 0; // текущий блок
+  size_t offset_ = 0; // занято в текущем блоке
+};
+
+// арена текущего потока
+Arena &threadArena();
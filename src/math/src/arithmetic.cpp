@@ -2,60 +2,104 @@
 // Created by Daniil Kazakov on 04.10.2025.
 //
 
+#include <cmath>
+
 #include "../include/arithmetic.hpp"
+#include "../include/kernels.hpp"
+#include "../include/multiplication.hpp"
+
+void prepareParams(Params &P) {
+  P.MACC = std::exp(1.0 + 1.0 / (2.0 * static_cast<double>(P.ALPHA) * static_cast<double>(P.ALPHA)));
+
+  // Граница нормы подписи в целых квадратах: ||x||^2 <= SIG_BOUND2 ровно тогда, когда
+  // sqrtl(||x||^2) <= bound (sqrtl монотонна, порог уточняется вокруг bound^2)
+  const long double bound = static_cast<long double>(P.ETA) * static_cast<long double>(P.SIGMA) *
+                            sqrtl(2.0L * static_cast<long double>(P.N));
+  const long double b2 = bound * bound;
+  constexpr int64_t CAP = int64_t{1} << 62;
+  int64_t t = !(b2 >= 0) ? -1 : b2 >= static_cast<long double>(CAP) ? CAP : static_cast<int64_t>(floorl(b2));
+  while (t < CAP && sqrtl(static_cast<long double>(t + 1)) <= bound) ++t;
+  while (t >= 0 && sqrtl(static_cast<long double>(t)) > bound) --t;
+  P.SIG_BOUND2 = t;
 
-int modQ(long long x) {
-  long long q = G_Q;
+  P.pow2 = P.Q > 1 && P.Q <= 65536 && (P.Q & (P.Q - 1)) == 0;
+  P.kernels = &selectKernels(P.N, P.Q);
+}
+
+int modQ(const Params &P, long long x) {
+  long long q = P.Q;
   x %= q;
   if (x < 0) x += q;
   return static_cast<int>(x);
 }
 
-int center(int a) {
-  int q = G_Q;
+int center(const Params &P, int a) {
+  int q = P.Q;
   int v = a % q;
   if (v < 0) v += q;
   if (v > q / 2) v -= q;
   return v;
 }
 
-Poly zeroPoly() { return Poly(G_N, 0); }
+Poly zeroPoly(const Params &P) { return Poly(P.N, 0); }
 
-Poly subMod(const Poly &A, const Poly &B) {
-  Poly R(G_N, 0);
-  for (int i = 0; i < G_N; ++i) R[i] = modQ(static_cast<long long>(A[i]) - B[i]);
+Poly subMod(const Params &P, const Poly &A, const Poly &B) {
+  Poly R(P.N, 0);
+  P.kernels->subMod(P, A, B, R);
   return R;
 }
 
-Poly mulModQ(const Poly &A, const Poly &B) {
-  PolyLL acc(G_N, 0);
-  for (int ii = 0; ii < G_N; ++ii)
-    if (A[ii]) {
-      for (int jj = 0; jj < G_N; ++jj)
-        if (B[jj]) {
-          int k = ii + jj;
-          if (k >= G_N) k -= G_N;
-          acc[k] += static_cast<long long>(A[ii]) * B[jj];
-        }
-    }
-  Poly R(G_N, 0);
-  for (int i = 0; i < G_N; ++i) R[i] = modQ(acc[i]);
+void subMod(const Params &P, const std::span<const int> A, const std::span<const int> B, const std::span<int> R) {
+  P.kernels->subMod(P, A, B, R);
+}
+
+Poly mulModQ(const Params &P, const Poly &A, const Poly &B) {
+  Poly R(P.N, 0);
+  P.kernels->mulModQ(P, A, B, R);
   return R;
 }
 
-Poly mulModPow2(const Poly &A, const Poly &B, int M) {
-  std::vector<long long> acc(G_N, 0);
+void mulModQ(const Params &P, const std::span<const int> A, const std::span<const int> B, const std::span<int> R) {
+  P.kernels->mulModQ(P, A, B, R);
+}
+
+void subModGeneric(const Params &P, const std::span<const int> A, const std::span<const int> B, const std::span<int> R) {
+  for (int i = 0; i < P.N; ++i) R[i] = modQ(P, static_cast<long long>(A[i]) - B[i]);
+}
+
+void mulModQGeneric(const Params &P, const std::span<const int> A, const std::span<const int> B, const std::span<int> R) {
+  mulCyclicModQ(A.data(), B.data(), P.N, P.Q, chooseMulMethod(P.N), R.data());
+}
+
+void mulPow2Generic(const Params &P, const std::span<const uint16_t> a, const std::span<const uint16_t> b,
+                    const std::span<uint16_t> r) {
+  mulCyclic16(a.data(), b.data(), P.N, r.data());
+}
+
+void mulPreparedModQGeneric(const Params &P, const std::span<const int> a, const PreparedOperand<long long> &b,
+                            const std::span<int> r) {
+  mulCyclicModQPrepared(a.data(), b, P.Q, r.data());
+}
+
+void mulPreparedPow2Generic(const Params &, const std::span<const uint16_t> a, const PreparedOperand<uint16_t> &b,
+                            const std::span<uint16_t> r) {
+  mulCyclic16Prepared(a.data(), b, r.data());
+}
+
+Poly mulModPow2(const Params &P, const Poly &A, const Poly &B, int M) {
+  const int n = P.N;
+  std::vector<long long> acc(n, 0);
   const long long mask = static_cast<long long>(M) - 1;
-  for (int ii = 0; ii < G_N; ++ii)
+  for (int ii = 0; ii < n; ++ii)
     if ((A[ii] & mask) != 0) {
-      for (int jj = 0; jj < G_N; ++jj)
+      for (int jj = 0; jj < n; ++jj)
         if ((B[jj] & mask) != 0) {
           int k = ii + jj;
-          if (k >= G_N) k -= G_N;
+          if (k >= n) k -= n;
           acc[k] += static_cast<long long>(A[ii]) * B[jj];
         }
     }
-  Poly R(G_N, 0);
-  for (int i = 0; i < G_N; ++i) R[i] = static_cast<int>(acc[i] & mask);
+  Poly R(n, 0);
+  for (int i = 0; i < n; ++i) R[i] = static_cast<int>(acc[i] & mask);
   return R;
 }
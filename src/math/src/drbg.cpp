@@ -0,0 +1,148 @@
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <random>
+
+#include "../include/drbg.hpp"
+
+namespace {
+  constexpr uint32_t SIGMA[4] = {0x61707865u, 0x3320646eu, 0x79622d32u, 0x6b206574u}; // "expand 32-byte k"
+
+  inline void quarter(uint32_t &a, uint32_t &b, uint32_t &c, uint32_t &d) {
+    a += b;
+    d = std::rotl(d ^ a, 16);
+    c += d;
+    b = std::rotl(b ^ c, 12);
+    a += b;
+    d = std::rotl(d ^ a, 8);
+    c += d;
+    b = std::rotl(b ^ c, 7);
+  }
+
+  void chachaBlock(const ChaChaDrbg::Key &key, const uint64_t counter, const uint64_t stream, uint32_t out[16]) {
+    uint32_t in[16] = {
+      SIGMA[0], SIGMA[1], SIGMA[2], SIGMA[3],
+      key[0], key[1], key[2], key[3], key[4], key[5], key[6], key[7],
+      static_cast<uint32_t>(counter), static_cast<uint32_t>(counter >> 32),
+      static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32)
+    };
+    uint32_t x[16];
+    std::memcpy(x, in, sizeof(x));
+    for (int r = 0; r < 10; ++r) {
+      quarter(x[0], x[4], x[8], x[12]);
+      quarter(x[1], x[5], x[9], x[13]);
+      quarter(x[2], x[6], x[10], x[14]);
+      quarter(x[3], x[7], x[11], x[15]);
+      quarter(x[0], x[5], x[10], x[15]);
+      quarter(x[1], x[6], x[11], x[12]);
+      quarter(x[2], x[7], x[8], x[13]);
+      quarter(x[3], x[4], x[9], x[14]);
+    }
+    for (int i = 0; i < 16; ++i) out[i] = x[i] + in[i];
+  }
+
+  uint64_t splitmix64(uint64_t &s) {
+    uint64_t z = (s += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+
+  struct DrbgMode {
+    std::mutex m;
+    std::atomic<uint64_t> generation{1};
+    bool deterministic = false;
+    ChaChaDrbg::Key master{};
+    std::atomic<uint64_t> nextThread{0};
+  };
+
+  DrbgMode &mode() {
+    static DrbgMode md;
+    return md;
+  }
+
+  ChaChaDrbg::Key entropyKey() {
+    std::random_device rd;
+    ChaChaDrbg::Key k;
+    for (auto &w: k) w = rd();
+    return k;
+  }
+}
+
+ChaChaDrbg::ChaChaDrbg(const Key &key, const uint64_t stream, const uint64_t counter)
+  : key_(key), stream_(stream), counter_(counter) {}
+
+void ChaChaDrbg::refill() {
+  uint32_t block[16];
+  for (size_t b = 0; b < BLOCKS; ++b) {
+    chachaBlock(key_, counter_++, stream_, block);
+    std::memcpy(buf_ + b * 8, block, sizeof(block));
+  }
+  pos_ = 0;
+}
+
+void ChaChaDrbg::fill(uint8_t *out, size_t len) {
+  while (len >= 8) {
+    const uint64_t v = (*this)();
+    std::memcpy(out, &v, 8);
+    out += 8;
+    len -= 8;
+  }
+  if (len) {
+    const uint64_t v = (*this)();
+    std::memcpy(out, &v, len);
+  }
+}
+
+ChaChaDrbg::Key ChaChaDrbg::deriveKey() {
+  Key k;
+  for (size_t i = 0; i < k.size(); i += 2) {
+    const uint64_t v = (*this)();
+    k[i] = static_cast<uint32_t>(v);
+    k[i + 1] = static_cast<uint32_t>(v >> 32);
+  }
+  return k;
+}
+
+void drbgSeed(uint64_t seed) {
+  DrbgMode &md = mode();
+  std::lock_guard lk(md.m);
+  for (size_t i = 0; i < md.master.size(); i += 2) {
+    const uint64_t v = splitmix64(seed);
+    md.master[i] = static_cast<uint32_t>(v);
+    md.master[i + 1] = static_cast<uint32_t>(v >> 32);
+  }
+  md.deterministic = true;
+  md.nextThread = 0;
+  md.generation.fetch_add(1);
+}
+
+void drbgSeedFromEntropy() {
+  DrbgMode &md = mode();
+  std::lock_guard lk(md.m);
+  md.deterministic = false;
+  md.generation.fetch_add(1);
+}
+
+bool drbgDeterministic() {
+  DrbgMode &md = mode();
+  std::lock_guard lk(md.m);
+  return md.deterministic;
+}
+
+ChaChaDrbg &threadDrbg() {
+  thread_local std::optional<ChaChaDrbg> rng;
+  thread_local uint64_t seenGeneration = 0;
+
+  DrbgMode &md = mode();
+  if (rng && seenGeneration == md.generation.load()) return *rng;
+
+  std::lock_guard lk(md.m);
+  const ChaChaDrbg::Key key = md.deterministic ? md.master : entropyKey();
+  const uint64_t stream = md.deterministic ? md.nextThread.fetch_add(1) : 0;
+  rng.emplace(key, stream);
+  seenGeneration = md.generation.load();
+  return *rng;
+}
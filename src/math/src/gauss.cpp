@@ -0,0 +1,38 @@
+#include <cmath>
+#include <memory>
+#include <mutex>
+
+#include "../include/gauss.hpp"
+
+DiscreteGaussCDT::DiscreteGaussCDT(const double sigma) : sigma_(sigma) {
+  // P(|k| > j) = erfc((j + 1/2) / (sigma * sqrt(2))); хвост считаем через erfc ради точности
+  const long double scale = 1.0L / (static_cast<long double>(sigma) * sqrtl(2.0L));
+  for (int j = 0;; ++j) {
+    const long double t = ldexpl(erfcl((static_cast<long double>(j) + 0.5L) * scale), 63);
+    const uint64_t v = t >= ldexpl(1.0L, 63) ? (UINT64_MAX >> 1) : static_cast<uint64_t>(t);
+    tail_.push_back(v);
+    if (v == 0) break;
+  }
+
+  guide_.assign((size_t{1} << GUIDE_BITS) + 1, 0);
+  size_t j = tail_.size() - 1;
+  for (size_t b = 0; b < guide_.size(); ++b) {
+    // j(u) не возрастает по u, поэтому идём от больших |k| к меньшим
+    const uint64_t u = b < (size_t{1} << GUIDE_BITS) ? static_cast<uint64_t>(b) << GUIDE_SHIFT : (UINT64_MAX >> 1);
+    while (j > 0 && tail_[j - 1] <= u) --j;
+    guide_[b] = static_cast<uint32_t>(j);
+  }
+}
+
+const DiscreteGaussCDT &gaussCDT(const double sigma) {
+  thread_local const DiscreteGaussCDT *last = nullptr;
+  if (last && last->sigma() == sigma) return *last;
+
+  static std::mutex m;
+  static std::vector<std::unique_ptr<DiscreteGaussCDT>> cache;
+  std::lock_guard lk(m);
+  for (const auto &t: cache)
+    if (t->sigma() == sigma) return *(last = t.get());
+  cache.push_back(std::make_unique<DiscreteGaussCDT>(sigma));
+  return *(last = cache.back().get());
+}
@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+#include "../include/gf2.hpp"
+
+namespace {
+  // p mod (X^n + 1): X^(n+k) == X^k
+  void foldModXn1(Poly2W &p, const int n) {
+    for (int i = deg2w(p); i >= n; --i)
+      if (p.bit(i)) {
+        p.flip(i);
+        p.flip(i - n);
+      }
+  }
+}
+
+int deg2w(const Poly2W &p, const int from) {
+  for (int wi = std::min(from >> 6, static_cast<int>(p.w.size()) - 1); wi >= 0; --wi) {
+    uint64_t word = p.w[wi];
+    if (wi == (from >> 6) && (from & 63) != 63) word &= (uint64_t{2} << (from & 63)) - 1;
+    if (word) return wi * 64 + 63 - std::countl_zero(word);
+  }
+  return -1;
+}
+
+int deg2w(const Poly2W &p) { return deg2w(p, static_cast<int>(p.w.size()) * 64 - 1); }
+
+void addShifted2w(Poly2W &A, const Poly2W &B, const int degB, const int k) {
+  if (degB < 0) return;
+  const int ws = k >> 6, bs = k & 63;
+  const int nb = (degB >> 6) + 1;
+  uint64_t *dst = A.w.data() + ws;
+  const uint64_t *src = B.w.data();
+  if (bs == 0) {
+    for (int i = 0; i < nb; ++i) dst[i] ^= src[i];
+    return;
+  }
+  uint64_t carry = 0;
+  for (int i = 0; i < nb; ++i) {
+    dst[i] ^= (src[i] << bs) | carry;
+    carry = src[i] >> (64 - bs);
+  }
+  if (carry) dst[nb] ^= carry;
+}
+
+bool invertMod2W(const Poly &f, const int n, Poly &inv2_out) {
+  // инварианты: va * f == a, vb * f == b (mod X^n + 1)
+  Poly2W a(n), b(n), va(2 * n), vb(2 * n);
+  a.flip(0);
+  a.flip(n);
+  for (int i = 0; i < n; ++i)
+    if (f[i] & 1) b.flip(i);
+  vb.flip(0);
+
+  int da = n, db = deg2w(b, n);
+  int dva = -1, dvb = 0;
+  while (db >= 0) {
+    // a <- a mod b, va <- va + (a div b) * vb, по одному члену частного
+    while (da >= db) {
+      const int s = da - db;
+      addShifted2w(a, b, db, s);
+      addShifted2w(va, vb, dvb, s);
+      dva = std::max(dva, dvb + s);
+      da = deg2w(a, da);
+    }
+    dva = deg2w(va, dva);
+    std::swap(a, b);
+    std::swap(va, vb);
+    std::swap(da, db);
+    std::swap(dva, dvb);
+  }
+  if (da != 0) return false;
+
+  foldModXn1(va, n);
+  inv2_out.assign(n, 0);
+  for (int i = 0; i < n; ++i) inv2_out[i] = va.bit(i);
+  return true;
+}
@@ -2,36 +2,84 @@
 // Created by Daniil Kazakov on 04.10.2025.
 //
 
-#include "../include/hash.hpp"
+#include <algorithm>
 
-EHash H_e_small(const Poly &z_modq, const std::vector<uint8_t> &msg) {
-  std::vector < uint8_t > buf;
-  buf.reserve(msg.size() + 2u * (size_t) G_N);
-  buf.insert(buf.end(), msg.begin(), msg.end());
-  for (int i = 0; i < G_N; ++i) {
-    uint16_t v = static_cast<uint16_t>(z_modq[i]);
-    buf.push_back(static_cast<uint8_t>(v & 0xFF));
-    buf.push_back(static_cast<uint8_t>(v >> 8));
-  }
-  uint32_t s1 = 0x243F6A88u, s2 = 0x85A308D3u;
+#include "../include/hash.hpp"
 
-  Poly e_small(G_N, 0);
-  for (size_t i = 0; i < buf.size(); ++i) {
-    s1 = (s1 + buf[i] + (s2 << 5) + (s2 >> 2)) * 2654435761u;
+namespace {
+  // одно поглощение байта; e -- e_small длины N
+  inline void absorbByte(const int n, const int alpha, uint32_t &s1, uint32_t &s2, int *e, const uint8_t b) {
+    s1 = (s1 + b + (s2 << 5) + (s2 >> 2)) * 2654435761u;
     s2 ^= (s1 << 7) | (s1 >> 25);
-    int pos = (int) (s1 % (uint32_t) G_N);
-    int u = (int) ((s2 & 0x7FFFFFFF) % (2 * G_ALPHA + 1));
-    int val = u - G_ALPHA;
-    int x = e_small[pos] + val;
-    if (x > G_ALPHA) x = G_ALPHA;
-    if (x < -G_ALPHA) x = -G_ALPHA;
-    e_small[pos] = x;
+    int pos = (int) (s1 % (uint32_t) n);
+    int u = (int) ((s2 & 0x7FFFFFFF) % (2 * alpha + 1));
+    int val = u - alpha;
+    int x = e[pos] + val;
+    if (x > alpha) x = alpha;
+    if (x < -alpha) x = -alpha;
+    e[pos] = x;
   }
-  Poly e_mod(G_N, 0);
-  for (int i = 0; i < G_N; ++i) {
-    int m = e_small[i] % G_Q;
-    if (m < 0) m += G_Q;
-    e_mod[i] = m;
+
+  // z поглощается как 2N байт (младший, старший) без промежуточного буфера
+  template<typename Coef>
+  void finish(const Params &P, const HashState &st, const Coef *z_modq, int *e_small, int *e_mod) {
+    std::copy(st.e_small.begin(), st.e_small.end(), e_small);
+    uint32_t s1 = st.s1, s2 = st.s2;
+    for (int i = 0; i < P.N; ++i) {
+      const auto v = static_cast<uint16_t>(z_modq[i]);
+      absorbByte(P.N, P.ALPHA, s1, s2, e_small, static_cast<uint8_t>(v & 0xFF));
+      absorbByte(P.N, P.ALPHA, s1, s2, e_small, static_cast<uint8_t>(v >> 8));
+    }
+    for (int i = 0; i < P.N; ++i) {
+      int m = e_small[i] % P.Q;
+      if (m < 0) m += P.Q;
+      e_mod[i] = m;
+    }
   }
-  return {e_small, e_mod};
+}
+
+HashState H_init(const Params &P) {
+  HashState st;
+  H_init(P, st);
+  return st;
+}
+
+void H_init(const Params &P, HashState &st) {
+  st.s1 = HashState{}.s1;
+  st.s2 = HashState{}.s2;
+  st.e_small.assign(P.N, 0);
+}
+
+void H_absorb(const Params &P, HashState &st, const uint8_t *data, const size_t len) {
+  uint32_t s1 = st.s1, s2 = st.s2;
+  int *e_small = st.e_small.data();
+  for (size_t i = 0; i < len; ++i) absorbByte(P.N, P.ALPHA, s1, s2, e_small, data[i]);
+  st.s1 = s1;
+  st.s2 = s2;
+}
+
+HashState H_absorb_msg(const Params &P, const std::vector<uint8_t> &msg) {
+  HashState st = H_init(P);
+  H_absorb(P, st, msg.data(), msg.size());
+  return st;
+}
+
+EHash H_finish(const Params &P, const HashState &st, const Poly &z_modq) {
+  EHash eh{Poly(P.N), Poly(P.N)};
+  finish(P, st, z_modq.data(), eh.e_small.data(), eh.e_mod.data());
+  return eh;
+}
+
+void H_finish(const Params &P, const HashState &st, const std::span<const int> z_modq, const std::span<int> e_small,
+              const std::span<int> e_mod) {
+  finish(P, st, z_modq.data(), e_small.data(), e_mod.data());
+}
+
+void H_finish(const Params &P, const HashState &st, const std::span<const uint16_t> z_modq, const std::span<int> e_small,
+              const std::span<int> e_mod) {
+  finish(P, st, z_modq.data(), e_small.data(), e_mod.data());
+}
+
+EHash H_e_small(const Params &P, const Poly &z_modq, const std::vector<uint8_t> &msg) {
+  return H_finish(P, H_absorb_msg(P, msg), z_modq);
 }
@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "../include/kernels.hpp"
+#include "../include/multiplication.hpp"
+
+namespace {
+  // размер scratch для karatsubaFixed<n> (как karatsubaScratch в multiplication.cpp)
+  template<int n>
+  constexpr size_t karatsubaFixedScratch() {
+    if constexpr (n <= KARATSUBA_BASE) return 1;
+    else return 4 * static_cast<size_t>((n + 1) / 2) + karatsubaFixedScratch<(n + 1) / 2>();
+  }
+
+  // uint16 умножаются в uint32 и обрезаются -- арифметика по модулю 2^16
+  template<typename T>
+  using MulWide = std::conditional_t<std::is_same_v<T, uint16_t>, uint32_t, T>;
+
+  // Карацуба с длиной как константой: база -- школьный метод фиксированного размера,
+  // его компилятор разворачивает и векторизует
+  template<int n, typename T>
+  void karatsubaFixed(const T *a, const T *b, T *r, T *scratch) {
+    if constexpr (n <= KARATSUBA_BASE) {
+      for (int i = 0; i < 2 * n - 1; ++i) r[i] = 0;
+      for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) r[i + j] = static_cast<T>(r[i + j] + static_cast<MulWide<T>>(a[i]) * b[j]);
+    } else {
+      constexpr int m = (n + 1) / 2;
+      constexpr int h = n - m;
+
+      T *sa = scratch;
+      T *sb = sa + m;
+      T *t = sb + m;
+      T *next = t + 2 * m;
+
+      for (int i = 0; i < h; ++i) {
+        sa[i] = static_cast<T>(a[i] + a[m + i]);
+        sb[i] = static_cast<T>(b[i] + b[m + i]);
+      }
+      if constexpr (h < m) {
+        sa[m - 1] = a[m - 1];
+        sb[m - 1] = b[m - 1];
+      }
+
+      karatsubaFixed<m>(a, b, r, next);
+      r[2 * m - 1] = 0;
+      karatsubaFixed<h>(a + m, b + m, r + 2 * m, next);
+
+      karatsubaFixed<m>(sa, sb, t, next);
+      for (int i = 0; i < 2 * m - 1; ++i) t[i] = static_cast<T>(t[i] - r[i]);
+      for (int i = 0; i < 2 * h - 1; ++i) t[i] = static_cast<T>(t[i] - r[2 * m + i]);
+      for (int i = 0; i < 2 * m - 1; ++i) r[m + i] = static_cast<T>(r[m + i] + t[i]);
+    }
+  }
+
+  // то же с подготовленным b (дерево в формате buildKaratsubaTree из multiplication.cpp)
+  template<int n, typename T>
+  void karatsubaFixedPrepared(const T *a, const T *bt, T *r, T *scratch) {
+    if constexpr (n <= KARATSUBA_BASE) {
+      for (int i = 0; i < 2 * n - 1; ++i) r[i] = 0;
+      for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) r[i + j] = static_cast<T>(r[i + j] + static_cast<MulWide<T>>(a[i]) * bt[j]);
+    } else {
+      constexpr int m = (n + 1) / 2;
+      constexpr int h = n - m;
+      constexpr size_t sm = karatsubaTreeSize(m), sh = karatsubaTreeSize(h);
+
+      T *sa = scratch;
+      T *t = sa + 2 * m; // раскладка scratch как у karatsubaFixed
+      T *next = t + 2 * m;
+
+      for (int i = 0; i < h; ++i) sa[i] = static_cast<T>(a[i] + a[m + i]);
+      if constexpr (h < m) sa[m - 1] = a[m - 1];
+
+      karatsubaFixedPrepared<m>(a, bt, r, next);
+      r[2 * m - 1] = 0;
+      karatsubaFixedPrepared<h>(a + m, bt + sm, r + 2 * m, next);
+
+      karatsubaFixedPrepared<m>(sa, bt + sm + sh, t, next);
+      for (int i = 0; i < 2 * m - 1; ++i) t[i] = static_cast<T>(t[i] - r[i]);
+      for (int i = 0; i < 2 * h - 1; ++i) t[i] = static_cast<T>(t[i] - r[2 * m + i]);
+      for (int i = 0; i < 2 * m - 1; ++i) r[m + i] = static_cast<T>(r[m + i] + t[i]);
+    }
+  }
+
+  template<int Q>
+  int reduceModQ(long long x) {
+    if constexpr ((Q & (Q - 1)) == 0) {
+      return static_cast<int>(x & (Q - 1));
+    } else {
+      x %= Q;
+      if (x < 0) x += Q;
+      return static_cast<int>(x);
+    }
+  }
+
+  // Умножение по модулю Q: метод выбирается по N (для наборов PARAM_SETS это Тоом-4, ниже
+  // MUL_TOOM4_FROM -- Карацуба общего движка), специализировано приведение % Q
+  template<int N, int Q>
+  void mulModQFixed(const Params &, const std::span<const int> A, const std::span<const int> B, const std::span<int> R) {
+    std::array<long long, N> acc;
+    mulCyclicAcc(A.data(), B.data(), N, chooseMulMethod(N), acc.data());
+    for (int i = 0; i < N; ++i) R[i] = reduceModQ<Q>(acc[i]);
+  }
+
+  // Q = 2^k: всё произведение в uint16 без промежуточных приведений, Карацубой с N как
+  // константой при любом N (Тоом-4 делит на 2, 3, 9 и по модулю 2^16 не работает)
+  template<int N>
+  void mulPow2Fixed(const Params &, const std::span<const uint16_t> a, const std::span<const uint16_t> b,
+                    const std::span<uint16_t> r) {
+    std::array<uint16_t, 2 * N - 1> lin;
+    std::array<uint16_t, karatsubaFixedScratch<N>()> scratch;
+    karatsubaFixed<N>(a.data(), b.data(), lin.data(), scratch.data());
+    for (int i = 0; i < N - 1; ++i) r[i] = static_cast<uint16_t>(lin[i] + lin[N + i]);
+    r[N - 1] = lin[N - 1];
+  }
+
+  template<int N, int Q>
+  void mulPreparedModQFixed(const Params &, const std::span<const int> A, const PreparedOperand<long long> &B,
+                            const std::span<int> R) {
+    std::array<long long, N> acc;
+    mulCyclicAccPrepared(A.data(), B, acc.data());
+    for (int i = 0; i < N; ++i) R[i] = reduceModQ<Q>(acc[i]);
+  }
+
+  template<int N>
+  void mulPreparedPow2Fixed(const Params &, const std::span<const uint16_t> a, const PreparedOperand<uint16_t> &b,
+                            const std::span<uint16_t> r) {
+    std::array<uint16_t, 2 * N - 1> lin;
+    std::array<uint16_t, karatsubaFixedScratch<N>()> scratch;
+    karatsubaFixedPrepared<N>(a.data(), b.tree.data(), lin.data(), scratch.data());
+    for (int i = 0; i < N - 1; ++i) r[i] = static_cast<uint16_t>(lin[i] + lin[N + i]);
+    r[N - 1] = lin[N - 1];
+  }
+
+  template<int N, int Q>
+  void subModFixed(const Params &, const std::span<const int> A, const std::span<const int> B, const std::span<int> R) {
+    for (int i = 0; i < N; ++i) R[i] = reduceModQ<Q>(static_cast<long long>(A[i]) - B[i]);
+  }
+
+  template<size_t I>
+  constexpr RingKernels makeKernels() {
+    constexpr ParamSet p = PARAM_SETS[I];
+    return {&PARAM_SETS[I], &mulModQFixed<p.n, p.q>, &subModFixed<p.n, p.q>, &mulPow2Fixed<p.n>,
+            &mulPreparedModQFixed<p.n, p.q>, &mulPreparedPow2Fixed<p.n>, &mulSparseAccN<p.n>,
+            &mulSparsePairN<p.n>};
+  }
+
+  template<size_t... I>
+  constexpr std::array<RingKernels, sizeof...(I)> makeKernelTable(std::index_sequence<I...>) {
+    return {makeKernels<I>()...};
+  }
+
+  constexpr auto SPECIALIZED_KERNELS = makeKernelTable(std::make_index_sequence<std::size(PARAM_SETS)>{});
+}
+
+const RingKernels &selectKernels(const int n, const int q) {
+  for (const RingKernels &k: SPECIALIZED_KERNELS)
+    if (k.set->n == n && k.set->q == q) return k;
+  return GENERIC_KERNELS;
+}
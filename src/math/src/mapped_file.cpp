@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <fstream>
+
+#include "../include/mapped_file.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+MappedFile::~MappedFile() { close(); }
+
+void MappedFile::close() {
+#ifndef _WIN32
+  if (mapped_) munmap(const_cast<uint8_t *>(data_), size_);
+#endif
+  data_ = nullptr;
+  size_ = 0;
+  mapped_ = false;
+  fallback_.clear();
+}
+
+#ifndef _WIN32
+bool MappedFile::open(const std::string &path) {
+  close();
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return false;
+  struct stat st{};
+  if (fstat(fd, &st) != 0) {
+    ::close(fd);
+    return false;
+  }
+  size_ = static_cast<size_t>(st.st_size);
+  if (size_ == 0) {
+    // пустой файл не отображается, окно просто пустое
+    ::close(fd);
+    return true;
+  }
+  void *p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd); // отображение держит файл само
+  if (p == MAP_FAILED) {
+    size_ = 0;
+    return false;
+  }
+  madvise(p, size_, MADV_SEQUENTIAL);
+  data_ = static_cast<const uint8_t *>(p);
+  mapped_ = true;
+  return true;
+}
+#else
+bool MappedFile::open(const std::string &path) {
+  close();
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  if (!in) return false;
+  fallback_.resize(static_cast<size_t>(in.tellg()));
+  in.seekg(0, std::ios::beg);
+  if (!in.read(reinterpret_cast<char *>(fallback_.data()), static_cast<std::streamsize>(fallback_.size()))) {
+    fallback_.clear();
+    return false;
+  }
+  data_ = fallback_.data();
+  size_ = fallback_.size();
+  return true;
+}
+#endif
+
+namespace {
+  // запасной путь: копирование кусками через буфер
+  bool copyBuffered(const std::string &src, const uint64_t offset, uint64_t len, const std::string &dst) {
+    std::ifstream in(src, std::ios::binary);
+    std::ofstream out(dst, std::ios::binary | std::ios::trunc);
+    if (!in || !out) return false;
+    in.seekg(static_cast<std::streamoff>(offset));
+    std::vector<char> buf(static_cast<size_t>(std::min<uint64_t>(len, uint64_t{1} << 20)));
+    while (len > 0) {
+      const auto n = static_cast<std::streamsize>(std::min<uint64_t>(len, buf.size()));
+      if (!in.read(buf.data(), n)) return false;
+      out.write(buf.data(), n);
+      len -= static_cast<uint64_t>(n);
+    }
+    out.close();
+    return static_cast<bool>(out);
+  }
+}
+
+bool copy_file_part(const std::string &src, const uint64_t offset, const uint64_t len, const std::string &dst) {
+#ifdef __linux__
+  const int in = ::open(src.c_str(), O_RDONLY | O_CLOEXEC);
+  if (in < 0) return false;
+  const int out = ::open(dst.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (out < 0) {
+    ::close(in);
+    return false;
+  }
+  auto inOff = static_cast<off_t>(offset);
+  uint64_t left = len;
+  bool ok = true;
+  while (left > 0) {
+    // copy_file_range копирует внутри ядра (на части ФС -- без копирования блоков);
+    // если ФС или ядро его не поддерживают, тот же путь даёт sendfile
+    ssize_t n = copy_file_range(in, &inOff, out, nullptr, left, 0);
+    if (n < 0) n = sendfile(out, in, &inOff, left);
+    if (n <= 0) {
+      ok = false;
+      break;
+    }
+    left -= static_cast<uint64_t>(n);
+  }
+  ok = ::close(out) == 0 && ok;
+  ::close(in);
+  if (ok) return true;
+  if (left == len) return copyBuffered(src, offset, len, dst); // ничего не скопировано ядром
+  return false;
+#else
+  return copyBuffered(src, offset, len, dst);
+#endif
+}
+
+bool write_private_file(const std::string &path, const std::span<const uint8_t> bytes) {
+#ifndef _WIN32
+  const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  if (fd < 0) return false;
+  // O_CREAT не трогает права уже существующего файла
+  bool ok = ::fchmod(fd, 0600) == 0;
+  const uint8_t *p = bytes.data();
+  size_t left = bytes.size();
+  while (ok && left > 0) {
+    const ssize_t n = ::write(fd, p, left);
+    if (n <= 0) {
+      ok = false;
+      break;
+    }
+    p += n;
+    left -= static_cast<size_t>(n);
+  }
+  return ::close(fd) == 0 && ok;
+#else
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+  out.close();
+  return static_cast<bool>(out);
+#endif
+}
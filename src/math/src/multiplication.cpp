@@ -0,0 +1,446 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "../include/multiplication.hpp"
+#include "../include/workspace.hpp"
+
+namespace {
+  // Тип произведения коэффициентов: uint16 умножаются в uint32 (без UB переполнения int),
+  // результат обрезается обратно до 16 бит -- это и есть арифметика по модулю 2^16
+  template<typename T>
+  struct MulWide {
+    using type = T;
+  };
+
+  template<>
+  struct MulWide<uint16_t> {
+    using type = uint32_t;
+  };
+
+  // r[0..2n-1) = a * b (линейное произведение), школьный метод
+  template<typename T>
+  void mulLinearSchoolbook(const T *a, const T *b, int n, T *r) {
+    using W = typename MulWide<T>::type;
+    for (int i = 0; i < 2 * n - 1; ++i) r[i] = 0;
+    for (int i = 0; i < n; ++i) {
+      const W ai = a[i];
+      if (!ai) continue;
+      for (int j = 0; j < n; ++j) r[i + j] = static_cast<T>(r[i + j] + ai * b[j]);
+    }
+  }
+
+  // Карацуба; scratch -- не меньше karatsubaScratch(n) элементов
+  template<typename T>
+  void mulLinearKaratsuba(const T *a, const T *b, int n, T *r, T *scratch) {
+    if (n <= KARATSUBA_BASE) {
+      mulLinearSchoolbook(a, b, n, r);
+      return;
+    }
+    const int m = (n + 1) / 2; // младшая половина
+    const int h = n - m; // старшая половина, h <= m
+
+    T *sa = scratch;
+    T *sb = sa + m;
+    T *t = sb + m; // 2m - 1
+    T *next = t + 2 * m;
+
+    for (int i = 0; i < m; ++i) {
+      sa[i] = static_cast<T>(a[i] + (i < h ? a[m + i] : 0));
+      sb[i] = static_cast<T>(b[i] + (i < h ? b[m + i] : 0));
+    }
+
+    // z0 -> r[0..2m-1), z2 -> r[2m..2n-1); между ними r[2m-1] = 0
+    mulLinearKaratsuba(a, b, m, r, next);
+    r[2 * m - 1] = 0;
+    if (h > 0) mulLinearKaratsuba(a + m, b + m, h, r + 2 * m, next);
+
+    mulLinearKaratsuba(sa, sb, m, t, next);
+    for (int i = 0; i < 2 * m - 1; ++i) t[i] = static_cast<T>(t[i] - r[i]);
+    for (int i = 0; i < 2 * h - 1; ++i) t[i] = static_cast<T>(t[i] - r[2 * m + i]);
+    for (int i = 0; i < 2 * m - 1; ++i) r[m + i] = static_cast<T>(r[m + i] + t[i]);
+  }
+
+  size_t karatsubaScratch(int n) {
+    size_t total = 0;
+    while (n > KARATSUBA_BASE) {
+      const int m = (n + 1) / 2;
+      total += 4 * static_cast<size_t>(m);
+      n = m;
+    }
+    return total + 1;
+  }
+
+  // дерево операнда b (karatsubaTreeSize(n) элементов): листья -- отрезки b и сумм половин
+  template<typename T>
+  void buildKaratsubaTree(const T *b, int n, T *tree) {
+    if (n <= KARATSUBA_BASE) {
+      std::copy(b, b + n, tree);
+      return;
+    }
+    const int m = (n + 1) / 2;
+    const int h = n - m;
+    std::vector<T> sb(m);
+    for (int i = 0; i < m; ++i) sb[i] = static_cast<T>(b[i] + (i < h ? b[m + i] : 0));
+    const size_t sm = karatsubaTreeSize(m), sh = karatsubaTreeSize(h);
+    buildKaratsubaTree(b, m, tree);
+    buildKaratsubaTree(b + m, h, tree + sm);
+    buildKaratsubaTree(sb.data(), m, tree + sm + sh);
+  }
+
+  // Карацуба с подготовленным b; scratch -- как у mulLinearKaratsuba
+  template<typename T>
+  void mulLinearKaratsubaPrepared(const T *a, const T *bt, int n, T *r, T *scratch) {
+    if (n <= KARATSUBA_BASE) {
+      mulLinearSchoolbook(a, bt, n, r);
+      return;
+    }
+    const int m = (n + 1) / 2;
+    const int h = n - m;
+    const size_t sm = karatsubaTreeSize(m), sh = karatsubaTreeSize(h);
+
+    T *sa = scratch;
+    T *t = sa + m;
+    T *next = t + 2 * m;
+    for (int i = 0; i < m; ++i) sa[i] = static_cast<T>(a[i] + (i < h ? a[m + i] : 0));
+
+    mulLinearKaratsubaPrepared(a, bt, m, r, next);
+    r[2 * m - 1] = 0;
+    if (h > 0) mulLinearKaratsubaPrepared(a + m, bt + sm, h, r + 2 * m, next);
+
+    mulLinearKaratsubaPrepared(sa, bt + sm + sh, m, t, next);
+    for (int i = 0; i < 2 * m - 1; ++i) t[i] = static_cast<T>(t[i] - r[i]);
+    for (int i = 0; i < 2 * h - 1; ++i) t[i] = static_cast<T>(t[i] - r[2 * m + i]);
+    for (int i = 0; i < 2 * m - 1; ++i) r[m + i] = static_cast<T>(r[m + i] + t[i]);
+  }
+
+  // Тоом-Кук 4: точки 0, 1, -1, 2, -2, 1/2 (с множителем 8), бесконечность.
+  // p -- 4m коэффициентов (дополнено нулями), e -- 7 значений по m.
+  void toom4Evaluate(const long long *p0, const int m, long long *e0) {
+    const long long *p1 = p0 + m, *p2 = p1 + m, *p3 = p2 + m;
+    for (int i = 0; i < m; ++i) {
+      const long long even1 = p0[i] + p2[i], odd1 = p1[i] + p3[i];
+      const long long even2 = p0[i] + 4 * p2[i], odd2 = 2 * p1[i] + 8 * p3[i];
+      e0[0 * m + i] = p0[i];
+      e0[1 * m + i] = even1 + odd1;
+      e0[2 * m + i] = even1 - odd1;
+      e0[3 * m + i] = even2 + odd2;
+      e0[4 * m + i] = even2 - odd2;
+      e0[5 * m + i] = 8 * p0[i] + 4 * p1[i] + 2 * p2[i] + p3[i];
+      e0[6 * m + i] = p3[i];
+    }
+  }
+
+  // 7 значений a в точках Тоома-4 (из арены текущей области)
+  std::span<long long> toom4EvaluateOperand(Arena &arena, const long long *a, const int n, const int m) {
+    const std::span<long long> A = arena.zeros<long long>(4 * m);
+    std::copy(a, a + n, A.begin());
+    const std::span<long long> ev = arena.alloc<long long>(7 * m);
+    toom4Evaluate(A.data(), m, ev.data());
+    return ev;
+  }
+
+  // w -- 7 произведений значений по 2m - 1, r -- линейное произведение (2n - 1)
+  void toom4Interpolate(const long long *w, const int n, const int m, long long *r) {
+    const int len = 2 * m - 1;
+    Arena &arena = threadArena();
+    const Arena::Scope scope(arena);
+    const std::span<long long> full = arena.zeros<long long>(8 * m);
+    for (int k = 0; k < len; ++k) {
+      const long long r0 = w[0 * len + k], r1 = w[1 * len + k], rm1 = w[2 * len + k];
+      const long long r2 = w[3 * len + k], rm2 = w[4 * len + k], rh = w[5 * len + k];
+      const long long rinf = w[6 * len + k];
+
+      const long long c0 = r0, c6 = rinf;
+      const long long e1 = (r1 + rm1) / 2, o1 = (r1 - rm1) / 2;
+      const long long e2 = (r2 + rm2) / 2, o2 = (r2 - rm2) / 4;
+
+      // чётные: c2 + c4 = P, 4c2 + 16c4 = S
+      const long long P = e1 - c0 - c6;
+      const long long S = e2 - c0 - 64 * c6;
+      const long long c4 = (S - 4 * P) / 12;
+      const long long c2 = P - c4;
+
+      // нечётные: c1+c3+c5 = o1, c1+4c3+16c5 = o2, 16c1+4c3+c5 = U
+      const long long U = (rh - 64 * c0 - 16 * c2 - 4 * c4 - c6) / 2;
+      const long long V = (o2 - o1) / 3; // c3 + 5c5
+      const long long W = (16 * o1 - U) / 3; // 4c3 + 5c5
+      const long long c3 = (W - V) / 3;
+      const long long c5 = (V - c3) / 5;
+      const long long c1 = o1 - c3 - c5;
+
+      full[k] += c0;
+      full[m + k] += c1;
+      full[2 * m + k] += c2;
+      full[3 * m + k] += c3;
+      full[4 * m + k] += c4;
+      full[5 * m + k] += c5;
+      full[6 * m + k] += c6;
+    }
+    for (int i = 0; i < 2 * n - 1; ++i) r[i] = full[i];
+  }
+
+  void mulLinearToom4(const long long *a, const long long *b, int n, long long *r) {
+    const int m = (n + 3) / 4;
+    const int len = 2 * m - 1;
+
+    Arena &arena = threadArena();
+    const Arena::Scope scope(arena);
+    const std::span<long long> evA = toom4EvaluateOperand(arena, a, n, m);
+    const std::span<long long> evB = toom4EvaluateOperand(arena, b, n, m);
+
+    const std::span<long long> w = arena.alloc<long long>(7 * static_cast<size_t>(len));
+    const std::span<long long> scratch = arena.alloc<long long>(karatsubaScratch(m));
+    for (int p = 0; p < 7; ++p)
+      mulLinearKaratsuba(evA.data() + p * m, evB.data() + p * m, m, w.data() + p * len, scratch.data());
+    toom4Interpolate(w.data(), n, m, r);
+  }
+
+  // evB -- 7 значений b по m (деревья Карацубы для них в 7 раз больше и не помещаются в L1)
+  void mulLinearToom4Prepared(const long long *a, const long long *evB, int n, long long *r) {
+    const int m = (n + 3) / 4;
+    const int len = 2 * m - 1;
+
+    Arena &arena = threadArena();
+    const Arena::Scope scope(arena);
+    const std::span<long long> evA = toom4EvaluateOperand(arena, a, n, m);
+    const std::span<long long> w = arena.alloc<long long>(7 * static_cast<size_t>(len));
+    const std::span<long long> scratch = arena.alloc<long long>(karatsubaScratch(m));
+    for (int p = 0; p < 7; ++p)
+      mulLinearKaratsuba(evA.data() + p * m, evB + p * m, m, w.data() + p * len, scratch.data());
+    toom4Interpolate(w.data(), n, m, r);
+  }
+
+  // ширина SIMD-регистра пакетного ядра (SSE2 -- базовый набор x86-64)
+  constexpr int BATCH_VECTOR_BYTES = 16;
+
+  // Карацуба по подготовленному b для пачки: "коэффициент" -- L полос подряд
+  template<int L, typename T>
+  void mulLinearKaratsubaBatch(const T *a, const T *bt, int n, T *r, T *scratch) {
+    static_assert(L * sizeof(T) % BATCH_VECTOR_BYTES == 0);
+    if (n <= KARATSUBA_BASE) {
+      // по выходному коэффициенту: L сумм лежат в векторных регистрах, из памяти читается
+      // только a; векторные типы GCC, т.к. автовекторизация развёрнутого цикла по полосам
+      // даёт перетасовки вместо pmullw/paddw
+      using V [[gnu::vector_size(BATCH_VECTOR_BYTES)]] = T;
+      constexpr int VL = BATCH_VECTOR_BYTES / sizeof(T), NV = L / VL;
+      for (int k = 0; k < 2 * n - 1; ++k) {
+        V acc[NV] = {};
+        const int lo = std::max(0, k - n + 1), hi = std::min(k, n - 1);
+        for (int i = lo; i <= hi; ++i) {
+          const T bj = bt[k - i];
+          for (int v = 0; v < NV; ++v) {
+            V x;
+            std::memcpy(&x, a + i * L + v * VL, sizeof(V));
+            acc[v] += x * bj;
+          }
+        }
+        std::memcpy(r + k * L, acc, sizeof(acc));
+      }
+      return;
+    }
+    const int m = (n + 1) / 2;
+    const int h = n - m;
+    const size_t sm = karatsubaTreeSize(m), sh = karatsubaTreeSize(h);
+
+    T *sa = scratch;
+    T *t = sa + m * L;
+    T *next = t + 2 * m * L;
+    for (int i = 0; i < h * L; ++i) sa[i] = static_cast<T>(a[i] + a[m * L + i]);
+    if (h < m) std::copy(a + (m - 1) * L, a + m * L, sa + (m - 1) * L);
+
+    mulLinearKaratsubaBatch<L>(a, bt, m, r, next);
+    std::fill(r + (2 * m - 1) * L, r + 2 * m * L, T{0});
+    mulLinearKaratsubaBatch<L>(a + m * L, bt + sm, h, r + 2 * m * L, next);
+
+    mulLinearKaratsubaBatch<L>(sa, bt + sm + sh, m, t, next);
+    for (int i = 0; i < (2 * m - 1) * L; ++i) t[i] = static_cast<T>(t[i] - r[i]);
+    for (int i = 0; i < (2 * h - 1) * L; ++i) t[i] = static_cast<T>(t[i] - r[2 * m * L + i]);
+    for (int i = 0; i < (2 * m - 1) * L; ++i) r[m * L + i] = static_cast<T>(r[m * L + i] + t[i]);
+  }
+
+  template<typename T>
+  void mulCyclicBatch(const T *x, const PreparedOperand<T> &b, T *r) {
+    constexpr int L = MUL_BATCH_LANES;
+    const int n = b.n;
+    Arena &arena = threadArena();
+    const Arena::Scope scope(arena);
+    const std::span<T> lin = arena.alloc<T>((2 * static_cast<size_t>(n) - 1) * L);
+    if (b.method == MulMethod::Schoolbook) {
+      mulLinearKaratsubaBatch<L>(x, b.tree.data(), n, lin.data(), static_cast<T *>(nullptr)); // n <= KARATSUBA_BASE
+    } else {
+      const std::span<T> scratch = arena.alloc<T>(karatsubaScratch(n) * L);
+      mulLinearKaratsubaBatch<L>(x, b.tree.data(), n, lin.data(), scratch.data());
+    }
+    for (int i = 0; i < (n - 1) * L; ++i) r[i] = static_cast<T>(lin[i] + lin[n * L + i]);
+    std::copy(lin.begin() + (n - 1) * L, lin.begin() + n * L, r + (n - 1) * L);
+  }
+
+  template<typename T>
+  void prepareOperandNarrow(const T *b, const int n, PreparedOperand<T> &out) {
+    out.n = n;
+    out.method = n < MUL_KARATSUBA_FROM ? MulMethod::Schoolbook : MulMethod::Karatsuba;
+    out.tree.assign(out.method == MulMethod::Karatsuba ? karatsubaTreeSize(n) : n, 0);
+    if (out.method == MulMethod::Karatsuba) buildKaratsubaTree(b, n, out.tree.data());
+    else std::copy(b, b + n, out.tree.begin());
+  }
+
+  template<typename T>
+  void foldCyclic(const T *lin, const int n, T *r) {
+    for (int i = 0; i < n - 1; ++i) r[i] = static_cast<T>(lin[i] + lin[n + i]);
+    r[n - 1] = lin[n - 1];
+  }
+}
+
+const char *mulMethodName(const MulMethod method) {
+  switch (method) {
+    case MulMethod::Schoolbook: return "schoolbook";
+    case MulMethod::Karatsuba: return "karatsuba";
+    case MulMethod::Toom4: return "toom4";
+  }
+  return "?";
+}
+
+void mulCyclicAcc(const int *A, const int *B, const int n, const MulMethod method, long long *acc) {
+  std::fill(acc, acc + n, 0);
+  if (method == MulMethod::Schoolbook) {
+    for (int ii = 0; ii < n; ++ii)
+      if (A[ii]) {
+        for (int jj = 0; jj < n; ++jj)
+          if (B[jj]) {
+            int k = ii + jj;
+            if (k >= n) k -= n;
+            acc[k] += static_cast<long long>(A[ii]) * B[jj];
+          }
+      }
+    return;
+  }
+
+  Arena &arena = threadArena();
+  const Arena::Scope scope(arena);
+  const std::span<long long> a = arena.alloc<long long>(n), b = arena.alloc<long long>(n);
+  std::copy(A, A + n, a.begin());
+  std::copy(B, B + n, b.begin());
+  const std::span<long long> lin = arena.alloc<long long>(2 * n - 1);
+  if (method == MulMethod::Karatsuba) {
+    const std::span<long long> scratch = arena.alloc<long long>(karatsubaScratch(n));
+    mulLinearKaratsuba(a.data(), b.data(), n, lin.data(), scratch.data());
+  } else {
+    mulLinearToom4(a.data(), b.data(), n, lin.data());
+  }
+
+  // свёртка по X^N = 1
+  for (int i = 0; i < n; ++i) acc[i] = lin[i];
+  for (int i = n; i < 2 * n - 1; ++i) acc[i - n] += lin[i];
+}
+
+PolyLL mulCyclic(const Poly &A, const Poly &B, const int n, const MulMethod method) {
+  PolyLL acc(n, 0);
+  mulCyclicAcc(A.data(), B.data(), n, method, acc.data());
+  return acc;
+}
+
+void mulCyclicModQ(const int *A, const int *B, const int n, const int q, const MulMethod method, int *R) {
+  Arena &arena = threadArena();
+  const Arena::Scope scope(arena);
+  const std::span<long long> acc = arena.alloc<long long>(n);
+  mulCyclicAcc(A, B, n, method, acc.data());
+  for (int i = 0; i < n; ++i) {
+    long long x = acc[i] % q;
+    if (x < 0) x += q;
+    R[i] = static_cast<int>(x);
+  }
+}
+
+Poly mulCyclicModQ(const Poly &A, const Poly &B, const int n, const int q, const MulMethod method) {
+  Poly R(n, 0);
+  mulCyclicModQ(A.data(), B.data(), n, q, method, R.data());
+  return R;
+}
+
+void prepareOperand(const int *B, const int n, const MulMethod method, PreparedOperand<long long> &out) {
+  out.n = n;
+  out.method = method;
+  if (method == MulMethod::Toom4) {
+    const int m = (n + 3) / 4;
+    const std::vector<long long> b(B, B + n);
+    Arena &arena = threadArena();
+    const Arena::Scope scope(arena);
+    const std::span<long long> ev = toom4EvaluateOperand(arena, b.data(), n, m);
+    out.tree.assign(ev.begin(), ev.end());
+    return;
+  }
+  const std::vector<long long> b(B, B + n);
+  out.tree.assign(method == MulMethod::Karatsuba ? karatsubaTreeSize(n) : n, 0);
+  if (method == MulMethod::Karatsuba) buildKaratsubaTree(b.data(), n, out.tree.data());
+  else std::copy(b.begin(), b.end(), out.tree.begin());
+}
+
+void prepareOperand16(const uint16_t *b, const int n, PreparedOperand<uint16_t> &out) { prepareOperandNarrow(b, n, out); }
+
+void prepareOperand32(const uint32_t *b, const int n, PreparedOperand<uint32_t> &out) { prepareOperandNarrow(b, n, out); }
+
+void mulCyclic16Batch(const uint16_t *x, const PreparedOperand<uint16_t> &b, uint16_t *r) { mulCyclicBatch(x, b, r); }
+
+void mulCyclic32Batch(const uint32_t *x, const PreparedOperand<uint32_t> &b, uint32_t *r) { mulCyclicBatch(x, b, r); }
+
+void mulCyclicAccPrepared(const int *A, const PreparedOperand<long long> &B, long long *acc) {
+  const int n = B.n;
+  Arena &arena = threadArena();
+  const Arena::Scope scope(arena);
+  const std::span<long long> a = arena.alloc<long long>(n), lin = arena.alloc<long long>(2 * n - 1);
+  std::copy(A, A + n, a.begin());
+  switch (B.method) {
+    case MulMethod::Schoolbook:
+      mulLinearSchoolbook(a.data(), B.tree.data(), n, lin.data());
+      break;
+    case MulMethod::Karatsuba:
+      mulLinearKaratsubaPrepared(a.data(), B.tree.data(), n, lin.data(),
+                                 arena.alloc<long long>(karatsubaScratch(n)).data());
+      break;
+    case MulMethod::Toom4:
+      mulLinearToom4Prepared(a.data(), B.tree.data(), n, lin.data());
+      break;
+  }
+  foldCyclic(lin.data(), n, acc);
+}
+
+void mulCyclicModQPrepared(const int *A, const PreparedOperand<long long> &B, const int q, int *R) {
+  Arena &arena = threadArena();
+  const Arena::Scope scope(arena);
+  const std::span<long long> acc = arena.alloc<long long>(B.n);
+  mulCyclicAccPrepared(A, B, acc.data());
+  for (int i = 0; i < B.n; ++i) {
+    long long x = acc[i] % q;
+    if (x < 0) x += q;
+    R[i] = static_cast<int>(x);
+  }
+}
+
+void mulCyclic16Prepared(const uint16_t *a, const PreparedOperand<uint16_t> &b, uint16_t *r) {
+  const int n = b.n;
+  Arena &arena = threadArena();
+  const Arena::Scope scope(arena);
+  const std::span<uint16_t> lin = arena.alloc<uint16_t>(2 * n - 1);
+  if (b.method == MulMethod::Schoolbook) {
+    mulLinearSchoolbook(a, b.tree.data(), n, lin.data());
+  } else {
+    const std::span<uint16_t> scratch = arena.alloc<uint16_t>(karatsubaScratch(n));
+    mulLinearKaratsubaPrepared(a, b.tree.data(), n, lin.data(), scratch.data());
+  }
+  foldCyclic(lin.data(), n, r);
+}
+
+void mulCyclic16(const uint16_t *a, const uint16_t *b, const int n, uint16_t *r) {
+  Arena &arena = threadArena();
+  const Arena::Scope scope(arena);
+  const std::span<uint16_t> lin = arena.alloc<uint16_t>(2 * n - 1);
+  if (n < MUL_KARATSUBA_FROM) {
+    mulLinearSchoolbook(a, b, n, lin.data());
+  } else {
+    const std::span<uint16_t> scratch = arena.alloc<uint16_t>(karatsubaScratch(n));
+    mulLinearKaratsuba(a, b, n, lin.data(), scratch.data());
+  }
+  foldCyclic(lin.data(), n, r);
+}
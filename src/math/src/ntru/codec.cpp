@@ -0,0 +1,273 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "ntru/codec.hpp"
+#include "workspace.hpp"
+
+namespace {
+  constexpr size_t COMPACT_HEADER = 1 + 1 + 2;
+
+  // Биты пишутся от младшего к старшему через 64-битный накопитель (порядок байт -- как
+  // у остальных форматов файла, little-endian). Накопитель сбрасывается в память целым
+  // словом после каждой записи, без ветвлений: длины кодов случайны, и переход
+  // "накопилось 32 бита" предсказывался бы плохо. Поэтому за концом данных нужен запас
+  // в 8 байт (он входит в compact_signature_bound); запас может быть затёрт нулями.
+  class BitWriter {
+  public:
+    explicit BitWriter(uint8_t *out) : out_(out) {}
+
+    // bits <= 32, v < 2^bits
+    void put(const uint64_t v, const int bits) {
+      acc_ |= v << fill_;
+      fill_ += bits;
+      std::memcpy(out_ + pos_, &acc_, sizeof(acc_));
+      pos_ += static_cast<size_t>(fill_ >> 3);
+      acc_ >>= fill_ & ~7;
+      fill_ &= 7;
+    }
+
+    // дописывает неполный байт нулями; итог -- число байт
+    size_t finish() {
+      if (fill_ > 0) out_[pos_++] = static_cast<uint8_t>(acc_);
+      acc_ = 0;
+      fill_ = 0;
+      return pos_;
+    }
+
+  private:
+    uint8_t *out_;
+    size_t pos_ = 0;
+    uint64_t acc_ = 0;
+    int fill_ = 0;
+  };
+
+  // Чтение через 64-битный буфер, пополняемый перед каждым значением без ветвлений
+  // (после refill в буфере не меньше 56 бит). Данные -- копия с нулевым запасом в 8 байт
+  // за концом: слово читается всегда, а указатель не уходит дальше конца, так что за
+  // концом читаются только нули.
+  class BitReader {
+  public:
+    BitReader(const uint8_t *data, const size_t size) : p_(data), end_(data + size) {}
+
+    void refill() {
+      uint64_t w;
+      std::memcpy(&w, p_, sizeof(w));
+      buf_ |= w << avail_;
+      p_ = std::min(p_ + ((63 - avail_) >> 3), end_);
+      avail_ |= 56;
+    }
+
+    uint64_t peek() const { return buf_; }
+
+    // bits <= 56 после refill
+    void skip(const int bits) {
+      buf_ >>= bits;
+      avail_ -= bits;
+      pos_ += static_cast<size_t>(bits);
+    }
+
+    uint32_t get(const int bits) {
+      const auto v = static_cast<uint32_t>(buf_ & ((uint64_t{1} << bits) - 1));
+      skip(bits);
+      return v;
+    }
+
+    // прочитано ровно size байт, добивка последнего -- нули
+    bool exhausted(const size_t size) const {
+      return (pos_ + 7) / 8 == size && (pos_ % 8 == 0 || (buf_ & ((uint64_t{1} << (8 - pos_ % 8)) - 1)) == 0);
+    }
+
+  private:
+    const uint8_t *p_;
+    const uint8_t *end_;
+    uint64_t buf_ = 0;
+    int avail_ = 0;
+    size_t pos_ = 0; // прочитано бит (больше длины данных -- данные оборваны)
+  };
+
+  int eBits(const Params &P) { return std::bit_width(2 * static_cast<unsigned>(P.ALPHA)); }
+
+  size_t eBytes(const Params &P) { return (static_cast<size_t>(P.N) * static_cast<size_t>(eBits(P)) + 7) / 8; }
+
+  // зигзаг центрированного коэффициента не больше Q, так что при k = qBits частное -- 0
+  int qBits(const Params &P) { return std::bit_width(static_cast<unsigned>(P.Q)); }
+
+  // x из [0, Q) -> зигзаг центрированного значения; false -- x вне [0, Q)
+  bool zigzag(const Params &P, const Poly &x, const std::span<uint32_t> u) {
+    const int n = P.N, q = P.Q, half = P.Q / 2;
+    bool ok = true;
+    for (int i = 0; i < n; ++i) {
+      const int v = x[i];
+      ok &= v >= 0 && v < q;
+      const int c = v - (q & -static_cast<int>(v > half));
+      u[i] = static_cast<uint32_t>(c) << 1 ^ static_cast<uint32_t>(c >> 31);
+    }
+    return ok;
+  }
+
+  struct RiceChoice {
+    int k;
+    uint64_t bits;
+  };
+
+  // k с наименьшей длиной кода n * (k + 1) + sum(u >> k). Для геометрического распределения
+  // он рядом с log2 среднего, так что длины считаются за один проход для четырёх соседних k;
+  // k = qBits (длина n * (qBits + 1) без прохода по u) ограничивает худший случай.
+  RiceChoice riceParameter(const Params &P, const std::span<const uint32_t> u) {
+    const uint64_t n = u.size();
+    uint64_t sum = 0;
+    for (const uint32_t v: u) sum += v;
+    const int top = qBits(P);
+    const int k0 = std::clamp(static_cast<int>(std::bit_width(sum / std::max<uint64_t>(n, 1))) - 2, 0, top);
+    uint64_t s[4] = {};
+    for (const uint32_t v: u)
+      for (int j = 0; j < 4; ++j) s[j] += v >> std::min(k0 + j, 31);
+    RiceChoice best{top, n * static_cast<uint64_t>(top + 1)};
+    for (int j = 0; j < 4 && k0 + j < top; ++j) {
+      const uint64_t bits = n * static_cast<uint64_t>(k0 + j + 1) + s[j];
+      if (bits < best.bits) best = {k0 + j, bits};
+    }
+    return best;
+  }
+
+  void putRice(uint8_t *out, const std::span<const uint32_t> u, const int k) {
+    BitWriter w(out);
+    const uint32_t low = (uint32_t{1} << k) - 1;
+    for (const uint32_t v: u) {
+      uint32_t q = v >> k;
+      // обычный случай -- частное, его ноль и остаток одной записью
+      if (q + 1 + static_cast<uint32_t>(k) <= 32) {
+        w.put((static_cast<uint64_t>(v & low) << (q + 1)) | ((uint64_t{1} << q) - 1), static_cast<int>(q) + 1 + k);
+        continue;
+      }
+      for (; q >= 32; q -= 32) w.put(0xFFFFFFFFu, 32);
+      w.put((uint64_t{1} << q) - 1, static_cast<int>(q) + 1);
+      w.put(v & low, k);
+    }
+    w.finish();
+  }
+
+  // одно значение Райса; false -- частное больше возможного
+  bool getRice(BitReader &r, const int k, const uint32_t maxQuot, uint32_t &u) {
+    r.refill();
+    uint64_t w = r.peek();
+    auto quot = static_cast<uint32_t>(std::countr_one(w));
+    if (quot + 1 + static_cast<uint32_t>(k) <= 56) {
+      u = (quot << k) | static_cast<uint32_t>((w >> (quot + 1)) & ((uint64_t{1} << k) - 1));
+      r.skip(static_cast<int>(quot) + 1 + k);
+      return quot <= maxQuot;
+    }
+    // длинная серия единиц: за концом данных читаются нули, так что цикл конечен
+    quot = 0;
+    int ones;
+    while ((ones = std::countr_one(w)) >= 56) {
+      quot += 56;
+      r.skip(56);
+      if (quot > maxQuot) return false;
+      r.refill();
+      w = r.peek();
+    }
+    quot += static_cast<uint32_t>(ones);
+    r.skip(ones + 1);
+    if (quot > maxQuot) return false;
+    r.refill();
+    u = (quot << k) | r.get(k);
+    return true;
+  }
+
+  // зигзаг -> коэффициент из [0, Q); false -- центрированное значение вне диапазона
+  bool unzigzag(const Params &P, const uint32_t u, int &x) {
+    const int q = P.Q, half = P.Q / 2;
+    const int c = static_cast<int>(u >> 1) ^ -static_cast<int>(u & 1);
+    x = c + (q & (c >> 31));
+    return c <= half && c > half - q;
+  }
+
+  // копия с нулевым запасом для BitReader
+  const uint8_t *padded(Arena &arena, const std::span<const uint8_t> in) {
+    const std::span<uint8_t> p = arena.zeros<uint8_t>(in.size() + 8);
+    std::copy(in.begin(), in.end(), p.begin());
+    return p.data();
+  }
+}
+
+size_t compact_signature_bound(const Params &P) {
+  const size_t rice = (static_cast<size_t>(P.N) * static_cast<size_t>(qBits(P) + 1) + 7) / 8;
+  return COMPACT_HEADER + eBytes(P) + 2 * rice + 8;
+}
+
+size_t encode_compact(const Params &P, const Signature &S, const std::span<uint8_t> out) {
+  const int n = P.N, q = P.Q, alpha = P.ALPHA;
+  Arena &arena = threadArena();
+  const Arena::Scope scope(arena);
+  const std::span<uint32_t> u1 = arena.alloc<uint32_t>(n), u2 = arena.alloc<uint32_t>(n);
+  if (!zigzag(P, S.x1, u1) || !zigzag(P, S.x2, u2)) return 0;
+  const RiceChoice r1 = riceParameter(P, u1), r2 = riceParameter(P, u2);
+  const size_t len1 = (r1.bits + 7) / 8, len2 = (r2.bits + 7) / 8;
+  if (len1 > UINT16_MAX) return 0;
+  out[0] = static_cast<uint8_t>(r1.k);
+  out[1] = static_cast<uint8_t>(r2.k);
+  out[2] = static_cast<uint8_t>(len1);
+  out[3] = static_cast<uint8_t>(len1 >> 8);
+
+  BitWriter w(out.data() + COMPACT_HEADER);
+  const int eb = eBits(P);
+  for (int i = 0; i < n; ++i) {
+    const int v = S.e[i];
+    const int c = v - (q & -static_cast<int>(v > q / 2));
+    if (v < 0 || v >= q || c < -alpha || c > alpha) return 0;
+    w.put(static_cast<uint32_t>(c + alpha), eb);
+  }
+  w.finish();
+  // потоки пишутся по порядку: запас за концом каждого затирается следующим
+  const size_t x1At = COMPACT_HEADER + eBytes(P);
+  putRice(out.data() + x1At, u1, r1.k);
+  putRice(out.data() + x1At + len1, u2, r2.k);
+  return x1At + len1 + len2;
+}
+
+bool decode_compact(const Params &P, const std::span<const uint8_t> in, Signature &S) {
+  const int n = P.N, q = P.Q, alpha = P.ALPHA;
+  const size_t x1At = COMPACT_HEADER + eBytes(P);
+  if (in.size() < x1At || in[0] > qBits(P) || in[1] > qBits(P)) return false;
+  const int k1 = in[0], k2 = in[1];
+  const size_t len1 = in[2] | static_cast<size_t>(in[3]) << 8;
+  if (len1 > in.size() - x1At) return false;
+  const size_t len2 = in.size() - x1At - len1;
+
+  Arena &arena = threadArena();
+  const Arena::Scope scope(arena);
+
+  // e -- значения фиксированной ширины: i-е начинается с бита i * eb, чтения независимы
+  const int eb = eBits(P);
+  const uint8_t *eData = padded(arena, in.subspan(COMPACT_HEADER, eBytes(P)));
+  const uint64_t eMask = (uint64_t{1} << eb) - 1;
+  bool ok = true;
+  S.e.resize(n);
+  int *e_out = S.e.data();
+  for (int i = 0; i < n; ++i) {
+    const size_t bit = static_cast<size_t>(i) * static_cast<size_t>(eb);
+    uint64_t w;
+    std::memcpy(&w, eData + bit / 8, sizeof(w));
+    const int e = static_cast<int>((w >> (bit % 8)) & eMask) - alpha;
+    ok &= e <= alpha;
+    e_out[i] = e + (q & (e >> 31));
+  }
+  const size_t eEnd = static_cast<size_t>(n) * static_cast<size_t>(eb);
+  if (!ok || (eEnd % 8 != 0 && (in[x1At - 1] >> (eEnd % 8)) != 0)) return false;
+
+  // x1 и x2 -- независимые потоки: чередование даёт две цепочки зависимостей вместо одной
+  BitReader r1(padded(arena, in.subspan(x1At, len1)), len1);
+  BitReader r2(padded(arena, in.subspan(x1At + len1, len2)), len2);
+  const uint32_t maxQuot1 = static_cast<uint32_t>(q) >> k1, maxQuot2 = static_cast<uint32_t>(q) >> k2;
+  S.x1.resize(n);
+  S.x2.resize(n);
+  int *x1 = S.x1.data(), *x2 = S.x2.data();
+  for (int i = 0; i < n && ok; ++i) {
+    uint32_t u1 = 0, u2 = 0;
+    ok &= getRice(r1, k1, maxQuot1, u1) & getRice(r2, k2, maxQuot2, u2);
+    ok &= unzigzag(P, u1, x1[i]) & unzigzag(P, u2, x2[i]);
+  }
+  return ok && r1.exhausted(len1) && r2.exhausted(len2);
+}
@@ -1,19 +1,41 @@
 #include <algorithm>
-#include <random>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
 
 #include "arithmetic.hpp"
+#include "drbg.hpp"
+#include "kernels.hpp"
+#include "mapped_file.hpp"
 #include "polynomials.hpp"
+#include "sparse.hpp"
 
 #include "ntru/keys.hpp"
 
-void genTernary(Poly &a) {
-  a.assign(G_N, 0);
-  std::vector<int> idx(G_N);
+void expandPublicKey(VerifierContext &ctx) {
+  const Params &P = ctx.params;
+  ctx.hp = PreparedPublicKey{};
+  if (P.pow2) {
+    ctx.h16.assign(ctx.h.begin(), ctx.h.end());
+    prepareOperand16(ctx.h16.data(), P.N, ctx.hp.narrow);
+  } else {
+    ctx.h16.clear();
+    prepareOperand(ctx.h.data(), P.N, chooseMulMethod(P.N), ctx.hp.wide);
+  }
+}
+
+bool expandPrivateKey(SignerContext &ctx) {
+  const int q = ctx.params.Q;
+  return toSparseTernary(ctx.F, q, ctx.Fsparse) && toSparseTernary(ctx.G, q, ctx.Gsparse);
+}
+
+void genTernary(const Params &P, Poly &a) {
+  a.assign(P.N, 0);
+  std::vector<int> idx(P.N);
   std::iota(idx.begin(), idx.end(), 0);
-  std::random_device rd;
-  std::mt19937 rng(rd());
-  std::ranges::shuffle(idx.begin(), idx.end(), rng);
-  int plus = G_D / 2, minus = G_D - plus;
+  std::ranges::shuffle(idx.begin(), idx.end(), threadDrbg());
+  int plus = P.D / 2, minus = P.D - plus;
 
   if (plus == minus) {
     plus--;
@@ -24,18 +46,219 @@ void genTernary(Poly &a) {
     a[idx[i]] = 1;
 
   for (int i = plus; i < plus + minus; ++i)
-    a[idx[i]] = G_Q - 1; // -1 mod Q
+    a[idx[i]] = P.Q - 1; // -1 mod Q
 }
 
-bool keygen() {
+bool keygen(SignerContext &ctx) {
+  const Params &P = ctx.params;
   for (int tries = 0; tries < 100; ++tries) {
-    genTernary(G_Fkey);
-    genTernary(G_Gkey);
-    Poly inv2(G_N, 0);
-    if (!invertMod2(G_Fkey, inv2)) continue;
-    const Poly Finv = henselLiftToQ(G_Fkey, inv2);
-    G_Hpub = mulModQ(Finv, G_Gkey);
+    genTernary(P, ctx.F);
+    genTernary(P, ctx.G);
+    Poly inv2(P.N, 0);
+    if (!invertMod2(P, ctx.F, inv2)) continue;
+    if (!expandPrivateKey(ctx)) continue;
+    const Poly Finv = henselLiftToQ(P, ctx.F, inv2);
+    PolyLL acc(P.N, 0);
+    P.kernels->mulSparseAcc(Finv.data(), ctx.Gsparse, P.N, acc.data());
+    ctx.h.assign(P.N, 0);
+    for (int i = 0; i < P.N; ++i) ctx.h[i] = modQ(P, acc[i]);
+    expandPublicKey(ctx);
     return true;
   }
   return false;
 }
+
+namespace {
+  constexpr char PRIVATE_KEY_MAGIC[4] = {'N', 'S', 'K', '1'};
+  constexpr size_t PRIVATE_KEY_HEADER = 4 + 4 + 4;
+}
+
+bool write_private_key(const SignerContext &ctx, const std::string &path) {
+  const Params &P = ctx.params;
+  if (P.Q > KEY_MAX_Q) {
+    std::cerr << "Закрытый ключ не поддерживает Q > " << KEY_MAX_Q << " (h хранится в uint16)\n";
+    return false;
+  }
+  std::vector<uint8_t> buf(PRIVATE_KEY_HEADER + 3u * 2u * static_cast<size_t>(P.N));
+  std::memcpy(buf.data(), PRIVATE_KEY_MAGIC, 4);
+  const auto n = static_cast<uint32_t>(P.N), q = static_cast<uint32_t>(P.Q);
+  std::memcpy(buf.data() + 4, &n, 4);
+  std::memcpy(buf.data() + 8, &q, 4);
+  uint8_t *p = buf.data() + PRIVATE_KEY_HEADER;
+  for (const Poly *K: {&ctx.F, &ctx.G, &ctx.h})
+    for (int i = 0; i < P.N; ++i, p += 2) {
+      const auto v = static_cast<uint16_t>(modQ(P, (*K)[i]));
+      std::memcpy(p, &v, 2);
+    }
+
+  if (!write_private_file(path, buf)) {
+    std::cerr << "Не удалось записать файл закрытого ключа: " << path << "\n";
+    return false;
+  }
+  return true;
+}
+
+bool read_private_key(SignerContext &ctx, const std::string &path) {
+  const Params &P = ctx.params;
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    std::cerr << "Не удалось открыть файл закрытого ключа: " << path << "\n";
+    return false;
+  }
+  std::vector<uint8_t> buf(PRIVATE_KEY_HEADER + 3u * 2u * static_cast<size_t>(P.N));
+  in.read(reinterpret_cast<char *>(buf.data()), static_cast<std::streamsize>(buf.size()));
+  if (in.gcount() < static_cast<std::streamsize>(PRIVATE_KEY_HEADER) || std::memcmp(buf.data(), PRIVATE_KEY_MAGIC, 4) != 0) {
+    std::cerr << "Некорректный формат закрытого ключа\n";
+    return false;
+  }
+  uint32_t n = 0, q = 0;
+  std::memcpy(&n, buf.data() + 4, 4);
+  std::memcpy(&q, buf.data() + 8, 4);
+  if (n != static_cast<uint32_t>(P.N) || q != static_cast<uint32_t>(P.Q)) {
+    std::cerr << "Несоответствие параметров: params N=" << P.N << ", Q=" << P.Q << "; key N=" << n << ", Q=" << q << "\n";
+    return false;
+  }
+  if (q > KEY_MAX_Q) {
+    std::cerr << "Закрытый ключ не поддерживает Q > " << KEY_MAX_Q << "\n";
+    return false;
+  }
+  if (in.gcount() != static_cast<std::streamsize>(buf.size()) || in.peek() != std::char_traits<char>::eof()) {
+    std::cerr << "Файл закрытого ключа повреждён (length mismatch)\n";
+    return false;
+  }
+
+  const uint8_t *p = buf.data() + PRIVATE_KEY_HEADER;
+  bool inRange = true;
+  for (Poly *K: {&ctx.F, &ctx.G, &ctx.h}) {
+    K->assign(P.N, 0);
+    for (int i = 0; i < P.N; ++i, p += 2) {
+      uint16_t v;
+      std::memcpy(&v, p, 2);
+      inRange &= v < q;
+      (*K)[i] = v;
+    }
+  }
+  if (!inRange) {
+    std::cerr << "Закрытый ключ повреждён (коэффициент вне [0, Q))\n";
+    return false;
+  }
+  if (!expandPrivateKey(ctx)) {
+    std::cerr << "Закрытый ключ повреждён (F, G не тернарные)\n";
+    return false;
+  }
+  expandPublicKey(ctx);
+  return true;
+}
+
+namespace {
+  constexpr char PUBLIC_KEY_MAGIC[4] = {'N', 'P', 'K', '1'};
+  constexpr size_t PUBLIC_KEY_HEADER = 4 + 4 + 4 + 4 + 8;
+
+  constexpr uint64_t FNV_OFFSET = 0xCBF29CE484222325ull;
+  constexpr uint64_t FNV_PRIME = 0x100000001B3ull;
+
+  uint64_t fnv1a(uint64_t h, const uint8_t *data, const size_t len) {
+    for (size_t i = 0; i < len; ++i) h = (h ^ data[i]) * FNV_PRIME;
+    return h;
+  }
+
+  // отпечаток по N, Q и уже упакованным коэффициентам (N значений uint16)
+  uint64_t fingerprintPacked(const uint32_t n, const uint32_t q, const uint8_t *coeffs) {
+    uint64_t h = fnv1a(FNV_OFFSET, reinterpret_cast<const uint8_t *>(&n), sizeof(n));
+    h = fnv1a(h, reinterpret_cast<const uint8_t *>(&q), sizeof(q));
+    return fnv1a(h, coeffs, 2u * static_cast<size_t>(n));
+  }
+
+  uint32_t paramSetId(const Params &P) {
+    const ParamSet *set = findParamSet(P.N, P.Q);
+    return set ? set->id : 0;
+  }
+}
+
+uint64_t public_key_fingerprint(const Params &P, const Poly &h) {
+  std::vector<uint8_t> coeffs(2u * static_cast<size_t>(P.N));
+  for (int i = 0; i < P.N; ++i) {
+    const auto v = static_cast<uint16_t>(modQ(P, h[i]));
+    std::memcpy(coeffs.data() + 2 * static_cast<size_t>(i), &v, 2);
+  }
+  return fingerprintPacked(static_cast<uint32_t>(P.N), static_cast<uint32_t>(P.Q), coeffs.data());
+}
+
+bool is_binary_public_key(const std::span<const uint8_t> bytes) {
+  return bytes.size() >= 4 && std::memcmp(bytes.data(), PUBLIC_KEY_MAGIC, 4) == 0;
+}
+
+bool write_public_key(const VerifierContext &ctx, const std::string &path) {
+  const Params &P = ctx.params;
+  if (P.Q > KEY_MAX_Q) return false;
+  std::vector<uint8_t> buf(PUBLIC_KEY_HEADER + 2u * static_cast<size_t>(P.N));
+  uint8_t *coeffs = buf.data() + PUBLIC_KEY_HEADER;
+  for (int i = 0; i < P.N; ++i) {
+    const auto v = static_cast<uint16_t>(modQ(P, ctx.h[i]));
+    std::memcpy(coeffs + 2 * static_cast<size_t>(i), &v, 2);
+  }
+  const auto n = static_cast<uint32_t>(P.N), q = static_cast<uint32_t>(P.Q), set = paramSetId(P);
+  const uint64_t fp = fingerprintPacked(n, q, coeffs);
+  std::memcpy(buf.data(), PUBLIC_KEY_MAGIC, 4);
+  std::memcpy(buf.data() + 4, &n, 4);
+  std::memcpy(buf.data() + 8, &q, 4);
+  std::memcpy(buf.data() + 12, &set, 4);
+  std::memcpy(buf.data() + 16, &fp, 8);
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char *>(buf.data()), static_cast<std::streamsize>(buf.size()));
+  return static_cast<bool>(out);
+}
+
+bool read_public_key(VerifierContext &ctx, const std::string &path) {
+  const Params &P = ctx.params;
+  MappedFile file;
+  if (!file.open(path)) {
+    std::cerr << "Не удалось открыть файл открытого ключа: " << path << "\n";
+    return false;
+  }
+  const std::span<const uint8_t> bytes = file.bytes();
+  if (bytes.size() < PUBLIC_KEY_HEADER || !is_binary_public_key(bytes)) {
+    std::cerr << "Некорректный формат открытого ключа\n";
+    return false;
+  }
+  uint32_t n = 0, q = 0, set = 0;
+  uint64_t fp = 0;
+  std::memcpy(&n, bytes.data() + 4, 4);
+  std::memcpy(&q, bytes.data() + 8, 4);
+  std::memcpy(&set, bytes.data() + 12, 4);
+  std::memcpy(&fp, bytes.data() + 16, 8);
+  if (n != static_cast<uint32_t>(P.N) || q != static_cast<uint32_t>(P.Q) || set != paramSetId(P)) {
+    std::cerr << "Несоответствие параметров: params N=" << P.N << ", Q=" << P.Q << "; key N=" << n << ", Q=" << q
+        << ", set=" << set << "\n";
+    return false;
+  }
+  if (q > KEY_MAX_Q) {
+    std::cerr << "Двоичный открытый ключ не поддерживает Q > " << KEY_MAX_Q << "\n";
+    return false;
+  }
+  if (bytes.size() != PUBLIC_KEY_HEADER + 2u * static_cast<size_t>(n)) {
+    std::cerr << "Файл открытого ключа повреждён (length mismatch)\n";
+    return false;
+  }
+  const uint8_t *coeffs = bytes.data() + PUBLIC_KEY_HEADER;
+  if (fingerprintPacked(n, q, coeffs) != fp) {
+    std::cerr << "Файл открытого ключа повреждён (fingerprint mismatch)\n";
+    return false;
+  }
+
+  ctx.h.resize(P.N);
+  bool inRange = true;
+  for (int i = 0; i < P.N; ++i) {
+    uint16_t v;
+    std::memcpy(&v, coeffs + 2 * static_cast<size_t>(i), 2);
+    inRange &= v < q;
+    ctx.h[i] = v;
+  }
+  if (!inRange) {
+    std::cerr << "Некорректный открытый ключ (коэффициент вне [0, Q))\n";
+    return false;
+  }
+  expandPublicKey(ctx);
+  return true;
+}
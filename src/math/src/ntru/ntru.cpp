@@ -3,206 +3,728 @@
 //
 
 #include "arithmetic.hpp"
+#include "drbg.hpp"
 #include "gauss.hpp"
+#include "kernels.hpp"
+#include "mapped_file.hpp"
+#include "sparse.hpp"
+#include "workspace.hpp"
 
+#include "ntru/codec.hpp"
 #include "ntru/keys.hpp"
 #include "ntru/ntru.hpp"
 
-#include <iostream>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <span>
+#include <thread>
 
-bool NTRUSign_once(const Poly &m, Poly &s_out) {
-  std::vector<int> fI(G_N, 0), gI(G_N, 0), mI(G_N, 0);
-  for (int i = 0; i < G_N; ++i) {
-    fI[i] = center(G_Fkey[i]);
-    gI[i] = center(G_Gkey[i]);
-    mI[i] = center(m[i]);
-  }
-
-  std::vector<long long> xA(G_N, 0), yA(G_N, 0);
-  for (int i = 0; i < G_N; ++i)
-    if (mI[i]) {
-      for (int j = 0; j < G_N; ++j) {
-        int k = i + j;
-        if (k >= G_N) k -= G_N;
-        xA[k] -= static_cast<long long>(mI[i]) * gI[j];
-        yA[k] += static_cast<long long>(mI[i]) * fI[j];
-      }
-    }
+namespace {
+  // Общий Q: коэффициенты int в [0, Q), приведение через %
+  struct GenericRing {
+    using Coef = int;
 
-  std::vector<int> kx(G_N, 0), ky(G_N, 0);
-  for (int i = 0; i < G_N; ++i) {
-    kx[i] = static_cast<int>(llround(static_cast<long double>(xA[i]) / static_cast<long double>(G_Q)));
-    ky[i] = static_cast<int>(llround(static_cast<long double>(yA[i]) / static_cast<long double>(G_Q)));
-  }
+    static Coef reduce(const Params &P, const long long x) { return modQ(P, x); }
+
+    static Coef sub(const Params &P, const Coef a, const Coef b) { return modQ(P, static_cast<long long>(a) - b); }
+
+    static int centered(const Params &P, const Coef v) { return center(P, v); }
 
-  std::vector<long long> sA(G_N, 0);
-  for (int i = 0; i < G_N; ++i) {
-    if (kx[i]) for (int j = 0; j < G_N; ++j) {
-      int k = i + j;
-      if (k >= G_N) k -= G_N;
-      sA[k] += static_cast<long long>(kx[i]) * fI[j];
+    static int canonical(const Params &, const Coef v) { return v; }
+
+    // R = x * h; без подготовленного ключа (контекст собран вручную) -- обычное умножение
+    static void mulPub(const VerifierContext &ctx, const std::span<const Coef> x, const std::span<Coef> R) {
+      const Params &P = ctx.params;
+      if (ctx.hp.wide.n == P.N) P.kernels->mulPreparedModQ(P, x, ctx.hp.wide, R);
+      else mulModQ(P, x, ctx.h, R);
     }
-    if (ky[i]) for (int j = 0; j < G_N; ++j) {
-      int k = i + j;
-      if (k >= G_N) k -= G_N;
-      sA[k] += static_cast<long long>(ky[i]) * gI[j];
+
+    static void finish(const Params &P, const HashState &st, const std::span<Coef> z, const std::span<int> e_small,
+                       const std::span<int> e_mod) {
+      H_finish(P, st, std::span<const Coef>(z), e_small, e_mod);
     }
-  }
-  s_out.assign(G_N, 0);
-  for (int i = 0; i < G_N; ++i) s_out[i] = static_cast<int>(sA[i]);
+  };
 
-  Poly sMod(G_N, 0);
-  for (int i = 0; i < G_N; ++i) sMod[i] = modQ(s_out[i]);
-  const Poly sh = mulModQ(sMod, G_Hpub);
-  std::vector<int> tI(G_N, 0);
-  for (int i = 0; i < G_N; ++i) tI[i] = center(modQ(static_cast<long long>(sh[i]) - m[i]));
+  // Q = 2^k <= 2^16: коэффициенты uint16 и арифметика по модулю 2^16 -- Q делит 2^16,
+  // поэтому переполнение и есть приведение. Маска Q-1 -- только при центрировании,
+  // перед хэшем и при выдаче подписи. Вдвое меньше памяти на многочлен, циклы без ветвлений.
+  struct Pow2Ring {
+    using Coef = uint16_t;
 
-  long double s2 = 0, t2 = 0;
-  for (int i = 0; i < G_N; ++i) {
-    s2 += static_cast<long double>(s_out[i]) * s_out[i];
-    t2 += static_cast<long double>(tI[i]) * tI[i];
-  }
-  const long double norm2 = s2 + (G_NU * G_NU) * t2;
-  return (norm2 <= static_cast<long double>(G_NORM_BOUND) * static_cast<long double>(G_NORM_BOUND));
-}
+    static Coef reduce(const Params &, const long long x) { return static_cast<uint16_t>(x); }
+
+    static Coef sub(const Params &, const Coef a, const Coef b) { return static_cast<uint16_t>(a - b); }
+
+    static int centered(const Params &P, const Coef v) { return centerPow2(v, P.Q); }
+
+    static int canonical(const Params &P, const Coef v) { return v & (P.Q - 1); }
 
-bool sign_strict(const std::vector<uint8_t> &msg, Signature &sig) {
-  std::random_device rd;
-  std::mt19937 rng(rd());
-  for (int tries = 0; tries < G_MAX_SIGN_ATT; ++tries) {
-    std::vector<int> y1I(G_N, 0), y2I(G_N, 0);
-    for (int i = 0; i < G_N; ++i) {
-      y1I[i] = sample_gauss_int(rng, (double) G_SIGMA);
-      y2I[i] = sample_gauss_int(rng, (double) G_SIGMA);
+    static void mulPub(const VerifierContext &ctx, const std::span<const Coef> x, const std::span<Coef> R) {
+      const Params &P = ctx.params;
+      if (ctx.hp.narrow.n == P.N) P.kernels->mulPreparedPow2(P, x, ctx.hp.narrow, R);
+      else P.kernels->mulPow2(P, x, ctx.h16, R);
     }
-    Poly y1(G_N, 0), y2(G_N, 0);
-    for (int i = 0; i < G_N; ++i) {
-      y1[i] = modQ(y1I[i]);
-      y2[i] = modQ(y2I[i]);
+
+    static void finish(const Params &P, const HashState &st, const std::span<Coef> z, const std::span<int> e_small,
+                       const std::span<int> e_mod) {
+      const auto mask = static_cast<uint16_t>(P.Q - 1);
+      for (uint16_t &v: z) v &= mask;
+      H_finish(P, st, std::span<const Coef>(z), e_small, e_mod);
     }
+  };
+
+  // Буферы всех этапов берутся из threadArena(): после прогрева подпись и проверка
+  // не обращаются к куче, кроме записи принятой подписи в Signature.
+
+  // шаг с лазейкой до умножения на h: s -- короткий вектор решётки для m
+  template<typename Ring>
+  void trapdoorS(const SignerContext &ctx, const std::span<const int> m, const std::span<int> s_out) {
+    using Coef = typename Ring::Coef;
+    const Params &P = ctx.params;
+    const int n = P.N;
+    Arena &arena = threadArena();
+    const Arena::Scope scope(arena);
+    const std::span<int> mI = arena.alloc<int>(n);
+    for (int i = 0; i < n; ++i) mI[i] = Ring::centered(P, static_cast<Coef>(m[i]));
 
-    Poly hy1 = mulModQ(G_Hpub, y1);
-    Poly z = subMod(y2, hy1);
-    auto [e_small, e_mod] = H_e_small(z, msg);
-
-    Poly sI;
-    if (!NTRUSign_once(e_mod, sI)) continue;
-    Poly sMod(G_N, 0);
-    for (int i = 0; i < G_N; ++i) sMod[i] = modQ(sI[i]);
-    Poly sh = mulModQ(sMod, G_Hpub);
-    std::vector<int> tI(G_N, 0);
-    for (int i = 0; i < G_N; ++i) tI[i] = center(modQ(static_cast<long long>(sh[i]) - e_mod[i]));
-
-    Poly x1(G_N, 0), x2(G_N, 0);
-    for (int i = 0; i < G_N; ++i) {
-      int xi1 = y1I[i] - sI[i];
-      int xi2 = y2I[i] - tI[i] - e_small[i];
-      x1[i] = modQ(xi1);
-      x2[i] = modQ(xi2);
+    // m*f и m*g за один проход; x = -m*g, y = m*f
+    const std::span<long long> mf = arena.zeros<long long>(n), mg = arena.zeros<long long>(n);
+    P.kernels->mulSparsePair(mI.data(), ctx.Fsparse, ctx.Gsparse, n, mf.data(), mg.data());
+
+    const std::span<int> kx = arena.alloc<int>(n), ky = arena.alloc<int>(n);
+    for (int i = 0; i < n; ++i) {
+      kx[i] = static_cast<int>(llround(static_cast<long double>(-mg[i]) / static_cast<long double>(P.Q)));
+      ky[i] = static_cast<int>(llround(static_cast<long double>(mf[i]) / static_cast<long double>(P.Q)));
     }
 
-    long double sigma2 = static_cast<long double>(G_SIGMA) * static_cast<long double>(G_SIGMA);
-    long double dot = 0.0L, v2 = 0.0L, xnorm2 = 0.0L;
-    for (int i = 0; i < G_N; ++i) {
-      int xv1 = center(x1[i]), xv2 = center(x2[i]);
-      int vv1 = -sI[i], vv2 = -tI[i] - e_small[i];
-      dot += static_cast<long double>(xv1) * vv1 + static_cast<long double>(xv2) * vv2;
-      v2 += static_cast<long double>(vv1) * vv1 + static_cast<long double>(vv2) * vv2;
-      xnorm2 += static_cast<long double>(xv1) * xv1 + static_cast<long double>(xv2) * xv2;
+    const std::span<long long> sA = arena.zeros<long long>(n);
+    P.kernels->mulSparseAcc(kx.data(), ctx.Fsparse, n, sA.data());
+    P.kernels->mulSparseAcc(ky.data(), ctx.Gsparse, n, sA.data());
+    for (int i = 0; i < n; ++i) s_out[i] = static_cast<int>(sA[i]);
+  }
+
+  // по готовому sh = s*h: t = s*h - m (центрированный) и граница нормы (s, t)
+  template<typename Ring>
+  bool trapdoorT(const SignerContext &ctx, const std::span<const int> m, const std::span<const int> s,
+                 const std::span<const typename Ring::Coef> sh, const std::span<int> t_out) {
+    using Coef = typename Ring::Coef;
+    const Params &P = ctx.params;
+    const int n = P.N;
+    for (int i = 0; i < n; ++i) t_out[i] = Ring::centered(P, Ring::sub(P, sh[i], static_cast<Coef>(m[i])));
+
+    // суммы квадратов точные в int64; в long double -- только итоговое сравнение с NU
+    int64_t s2 = 0, t2 = 0;
+    for (int i = 0; i < n; ++i) {
+      s2 += static_cast<int64_t>(s[i]) * s[i];
+      t2 += static_cast<int64_t>(t_out[i]) * t_out[i];
     }
-    long double exponent = (dot - 0.5L * v2) / sigma2;
+    if (P.NU == 1.0) return s2 + t2 <= static_cast<int64_t>(P.NORM_BOUND) * P.NORM_BOUND;
+    const long double norm2 = static_cast<long double>(s2) + (P.NU * P.NU) * static_cast<long double>(t2);
+    return (norm2 <= static_cast<long double>(P.NORM_BOUND) * static_cast<long double>(P.NORM_BOUND));
+  }
+
+  template<typename Ring>
+  bool signOnce(const SignerContext &ctx, const std::span<const int> m, const std::span<int> s_out,
+                const std::span<int> t_out) {
+    using Coef = typename Ring::Coef;
+    const Params &P = ctx.params;
+    const int n = P.N;
+    trapdoorS<Ring>(ctx, m, s_out);
+    Arena &arena = threadArena();
+    const Arena::Scope scope(arena);
+    const std::span<Coef> sMod = arena.alloc<Coef>(n), sh = arena.alloc<Coef>(n);
+    for (int i = 0; i < n; ++i) sMod[i] = Ring::reduce(P, s_out[i]);
+    Ring::mulPub(ctx, sMod, sh);
+    return trapdoorT<Ring>(ctx, m, s_out, sh, t_out);
+  }
+
+  // отсчёты маски: y1, y2 -- Гаусс, монета отбора u -- следующее слово того же rng
+  void drawMask(const SignerContext &ctx, ChaChaDrbg &rng, const std::span<int> y1I, const std::span<int> y2I,
+                double &u) {
+    const Params &P = ctx.params;
+    const DiscreteGaussCDT &gauss = gaussCDT((double) P.SIGMA);
+    gauss.fill(rng, y1I.data(), P.N);
+    gauss.fill(rng, y2I.data(), P.N);
+    std::uniform_real_distribution<double> U(0.0, 1.0);
+    u = U(rng);
+  }
+
+  // z = y2 - h*y1 в [0, Q) по готовому hy1
+  template<typename Ring>
+  void maskZ(const Params &P, const std::span<const int> y2I, const std::span<const typename Ring::Coef> hy1,
+             const std::span<int> z) {
+    for (int i = 0; i < P.N; ++i) z[i] = Ring::canonical(P, Ring::sub(P, Ring::reduce(P, y2I[i]), hy1[i]));
+  }
+
+  // Офлайн-часть попытки (от сообщения не зависит): y1, y2, u и z = y2 - h*y1
+  template<typename Ring>
+  void prepareMask(const SignerContext &ctx, ChaChaDrbg &rng, const std::span<int> y1I, const std::span<int> y2I,
+                   const std::span<int> z, double &u) {
+    using Coef = typename Ring::Coef;
+    const Params &P = ctx.params;
+    const int n = P.N;
+    drawMask(ctx, rng, y1I, y2I, u);
+    Arena &arena = threadArena();
+    const Arena::Scope scope(arena);
+    const std::span<Coef> y1 = arena.alloc<Coef>(n), hy1 = arena.alloc<Coef>(n);
+    for (int i = 0; i < n; ++i) y1[i] = Ring::reduce(P, y1I[i]);
+    Ring::mulPub(ctx, y1, hy1);
+    maskZ<Ring>(P, y2I, hy1, z);
+  }
+
+  // отбор по готовым s, t: x = y - (s, t + e_small); true -- подпись принята и записана в sig
+  template<typename Ring>
+  bool acceptAttempt(const SignerContext &ctx, const std::span<const int> y1I, const std::span<const int> y2I,
+                     const std::span<const int> e_small, const std::span<const int> e_mod,
+                     const std::span<const int> sI, const std::span<const int> tI, const double u, Signature &sig) {
+    using Coef = typename Ring::Coef;
+    const Params &P = ctx.params;
+    const int n = P.N;
+    Arena &arena = threadArena();
+    const Arena::Scope scope(arena);
+    const std::span<int> x1 = arena.alloc<int>(n), x2 = arena.alloc<int>(n);
+    long double sigma2 = static_cast<long double>(P.SIGMA) * static_cast<long double>(P.SIGMA);
+    // скалярные произведения целых -- точные суммы в int64
+    int64_t dot = 0, v2 = 0, xnorm2 = 0;
+    for (int i = 0; i < n; ++i) {
+      const Coef c1 = Ring::reduce(P, y1I[i] - sI[i]);
+      const Coef c2 = Ring::reduce(P, y2I[i] - tI[i] - e_small[i]);
+      x1[i] = Ring::canonical(P, c1);
+      x2[i] = Ring::canonical(P, c2);
+      const int64_t xv1 = Ring::centered(P, c1), xv2 = Ring::centered(P, c2);
+      const int64_t vv1 = -sI[i], vv2 = -tI[i] - e_small[i];
+      dot += xv1 * vv1 + xv2 * vv2;
+      v2 += vv1 * vv1 + vv2 * vv2;
+      xnorm2 += xv1 * xv1 + xv2 * xv2;
+    }
+    long double exponent = (static_cast<long double>(dot) - 0.5L * static_cast<long double>(v2)) / sigma2;
     if (exponent > 700.0L) exponent = 700.0L;
     if (exponent < -700.0L) exponent = -700.0L;
     long double R = expl(exponent);
-    long double p = R / G_MACC;
+    long double p = R / P.MACC;
     if (p > 1.0L) p = 1.0L;
     if (!(p == p) || !std::isfinite(static_cast<double>(p))) p = 0.0L;
-    std::uniform_real_distribution<double> U(0.0, 1.0);
-    if (U(rng) > static_cast<double>(p)) continue;
+    if (u > static_cast<double>(p)) return false;
 
-    long double bound = static_cast<long double>(G_ETA) * static_cast<long double>(G_SIGMA) * sqrtl(2.0L * static_cast<long double>(G_N));
-    if (sqrtl(xnorm2) > bound) continue;
+    if (xnorm2 > P.SIG_BOUND2) return false;
 
-    sig.x1 = std::move(x1);
-    sig.x2 = std::move(x2);
-    sig.e = std::move(e_mod);
+    // при повторном использовании sig память его векторов не перевыделяется
+    sig.x1.assign(x1.begin(), x1.end());
+    sig.x2.assign(x2.begin(), x2.end());
+    sig.e.assign(e_mod.begin(), e_mod.end());
     return true;
   }
-  return false;
+
+  // онлайн-часть: хэш, шаг с лазейкой и отбор; true -- подпись принята
+  template<typename Ring>
+  bool attemptWithMask(const SignerContext &ctx, const HashState &msgHash, const std::span<const int> y1I,
+                       const std::span<const int> y2I, const std::span<const int> z, const double u, Signature &sig) {
+    const Params &P = ctx.params;
+    const int n = P.N;
+    Arena &arena = threadArena();
+    const Arena::Scope scope(arena);
+    const std::span<int> e_small = arena.alloc<int>(n), e_mod = arena.alloc<int>(n);
+    H_finish(P, msgHash, z, e_small, e_mod);
+
+    // s, t и s*h считаются один раз внутри signOnce
+    const std::span<int> sI = arena.alloc<int>(n), tI = arena.alloc<int>(n);
+    if (!signOnce<Ring>(ctx, e_mod, sI, tI)) return false;
+    return acceptAttempt<Ring>(ctx, y1I, y2I, e_small, e_mod, sI, tI, u, sig);
+  }
+
+  // одна попытка маскирования; true -- подпись принята
+  template<typename Ring>
+  bool signAttempt(const SignerContext &ctx, ChaChaDrbg &rng, const HashState &msgHash, Signature &sig) {
+    const int n = ctx.params.N;
+    Arena &arena = threadArena();
+    const Arena::Scope scope(arena);
+    const std::span<int> y1I = arena.alloc<int>(n), y2I = arena.alloc<int>(n), z = arena.alloc<int>(n);
+    double u;
+    prepareMask<Ring>(ctx, rng, y1I, y2I, z, u);
+    return attemptWithMask<Ring>(ctx, msgHash, y1I, y2I, z, u, sig);
+  }
+
+  // проверка по готовому произведению h*x1 (в арифметике Ring) -- общая часть одиночной
+  // и пакетной проверки
+  template<typename Ring>
+  SigStatus checkWith(const VerifierContext &ctx, const HashState &msgHash, const Signature &S,
+                      const std::span<const typename Ring::Coef> hx1) {
+    using Coef = typename Ring::Coef;
+    const Params &P = ctx.params;
+    const int n = P.N;
+    Arena &arena = threadArena();
+    const Arena::Scope scope(arena);
+    const std::span<Coef> x1 = arena.alloc<Coef>(n), x2 = arena.alloc<Coef>(n), z = arena.alloc<Coef>(n);
+    for (int i = 0; i < n; ++i) {
+      x1[i] = Ring::reduce(P, S.x1[i]);
+      x2[i] = Ring::reduce(P, S.x2[i]);
+      z[i] = Ring::sub(P, x2[i], hx1[i]);
+    }
+    const std::span<int> e_small = arena.alloc<int>(n), e_mod = arena.alloc<int>(n);
+    Ring::finish(P, msgHash, z, e_small, e_mod);
+    for (int i = 0; i < n; ++i)
+      if (e_mod[i] != S.e[i]) return SigStatus::HashMismatch;
+
+    int64_t x2norm = 0;
+    for (int i = 0; i < n; ++i) {
+      const int64_t a = Ring::centered(P, x1[i]);
+      const int64_t b = Ring::centered(P, x2[i]);
+      x2norm += a * a + b * b;
+    }
+
+    if (x2norm > P.SIG_BOUND2) return SigStatus::Norm;
+    return SigStatus::Ok;
+  }
+
+  template<typename Ring>
+  SigStatus verifyWith(const VerifierContext &ctx, const HashState &msgHash, const Signature &S) {
+    using Coef = typename Ring::Coef;
+    const Params &P = ctx.params;
+    const int n = P.N;
+    Arena &arena = threadArena();
+    const Arena::Scope scope(arena);
+    const std::span<Coef> x1 = arena.alloc<Coef>(n), hx1 = arena.alloc<Coef>(n);
+    for (int i = 0; i < n; ++i) x1[i] = Ring::reduce(P, S.x1[i]);
+    Ring::mulPub(ctx, x1, hx1);
+    return checkWith<Ring>(ctx, msgHash, S, hx1);
+  }
+
+  void mulBatch(const uint16_t *x, const PreparedOperand<uint16_t> &b, uint16_t *r) { mulCyclic16Batch(x, b, r); }
+
+  void mulBatch(const uint32_t *x, const PreparedOperand<uint32_t> &b, uint32_t *r) { mulCyclic32Batch(x, b, r); }
+
+  // h для пакетных произведений при Q = 2^k: подготовленный ключ контекста или local
+  const PreparedOperand<uint16_t> &batchKey16(const VerifierContext &ctx, PreparedOperand<uint16_t> &local) {
+    if (ctx.hp.narrow.n == ctx.params.N) return ctx.hp.narrow;
+    const Poly16 h16(ctx.h.begin(), ctx.h.end());
+    prepareOperand16(h16.data(), ctx.params.N, local);
+    return local;
+  }
+
+  // h в uint32-полосах; false -- коэффициенты произведения двух многочленов из [0, Q)
+  // могут не поместиться в uint32, пакетный путь неприменим
+  bool batchKey32(const VerifierContext &ctx, PreparedOperand<uint32_t> &out) {
+    const Params &P = ctx.params;
+    const auto q1 = static_cast<uint64_t>(P.Q - 1);
+    if (static_cast<uint64_t>(P.N) * q1 * q1 >= (uint64_t{1} << 32)) return false;
+    const std::vector<uint32_t> h32(ctx.h.begin(), ctx.h.end());
+    prepareOperand32(h32.data(), P.N, out);
+    return true;
+  }
+
+  // x[i * L + l] = i-й коэффициент многочлена полосы l (src -- по n на полосу), мёртвые полосы -- 0
+  template<typename Ring, typename Lane>
+  void gatherLanes(const Params &P, const std::span<const int> src, const std::span<const bool> live,
+                   const std::span<Lane> x) {
+    constexpr int L = MUL_BATCH_LANES;
+    for (int i = 0; i < P.N; ++i)
+      for (int l = 0; l < L; ++l)
+        x[i * L + l] = live[l] ? static_cast<Lane>(Ring::reduce(P, src[static_cast<size_t>(l) * P.N + i])) : Lane{0};
+  }
+
+  template<typename Ring, typename Lane>
+  void scatterLane(const Params &P, const Lane *r, const int l, const std::span<typename Ring::Coef> out) {
+    for (int i = 0; i < P.N; ++i) out[i] = Ring::reduce(P, static_cast<long long>(r[i * MUL_BATCH_LANES + l]));
+  }
+
+  // Подписи идут пачками по MUL_BATCH_LANES: x1 пачки в чередующейся раскладке, все h*x1
+  // одним пакетным умножением (полосы Lane -- по модулю 2^16 или 2^32), дальше checkWith
+  template<typename Ring, typename Lane>
+  void verifyBatchWith(const VerifierContext &ctx, const std::span<const HashState> hashes,
+                       const std::span<const Signature> sigs, const PreparedOperand<Lane> &hb,
+                       const std::span<SigStatus> status) {
+    using Coef = typename Ring::Coef;
+    constexpr int L = MUL_BATCH_LANES;
+    const Params &P = ctx.params;
+    const int n = P.N;
+    Arena &arena = threadArena();
+    const Arena::Scope scope(arena);
+    const std::span<Lane> X = arena.alloc<Lane>(static_cast<size_t>(n) * L), R = arena.alloc<Lane>(static_cast<size_t>(n) * L);
+    const std::span<Coef> hx1 = arena.alloc<Coef>(n);
+    for (size_t b0 = 0; b0 < sigs.size(); b0 += L) {
+      const int lanes = static_cast<int>(std::min<size_t>(L, sigs.size() - b0));
+      for (int i = 0; i < n; ++i)
+        for (int l = 0; l < L; ++l)
+          X[i * L + l] = l < lanes ? static_cast<Lane>(Ring::reduce(P, sigs[b0 + l].x1[i])) : Lane{0};
+      mulBatch(X.data(), hb, R.data());
+      for (int l = 0; l < lanes; ++l) {
+        scatterLane<Ring>(P, R.data(), l, hx1);
+        status[b0 + l] = checkWith<Ring>(ctx, hashes[b0 + l], sigs[b0 + l], hx1);
+      }
+    }
+  }
+
+  // MUL_BATCH_LANES слотов, в каждом -- своё сообщение и его цикл отбора. Поля слотов
+  // (y1, y2, e, s, ...) хранятся массивами по полям, слот l -- отрезок [l*N, (l+1)*N).
+  // За раунд каждый живой слот делает одну попытку; оба умножения на h (h*y1 и s*h) идут
+  // одним пакетным произведением на все слоты. Принятый или исчерпавший попытки слот
+  // сразу берёт следующее сообщение. Ключ подписи сообщения берётся из генератора потока
+  // в порядке сообщений, попытка k -- поток ChaCha20 с номером k: подписи те же, что у
+  // sign_strict в цикле.
+  template<typename Ring, typename Lane>
+  void signBatchWith(const SignerContext &ctx, const std::span<const std::vector<uint8_t>> msgs,
+                     const std::span<Signature> sigs, const PreparedOperand<Lane> &hb, std::vector<bool> &ok) {
+    using Coef = typename Ring::Coef;
+    constexpr int L = MUL_BATCH_LANES;
+    const Params &P = ctx.params;
+    const int n = P.N;
+    Arena &arena = threadArena();
+    const Arena::Scope scope(arena);
+    const size_t soa = static_cast<size_t>(n) * L;
+    const std::span<int> y1 = arena.alloc<int>(soa), y2 = arena.alloc<int>(soa), z = arena.alloc<int>(soa);
+    const std::span<int> eSmall = arena.alloc<int>(soa), eMod = arena.alloc<int>(soa);
+    const std::span<int> s = arena.alloc<int>(soa), t = arena.alloc<int>(soa);
+    const std::span<Lane> X = arena.alloc<Lane>(soa), R = arena.alloc<Lane>(soa);
+    const std::span<Coef> prod = arena.alloc<Coef>(n);
+    auto lane = [n](const std::span<int> f, const int l) { return f.subspan(static_cast<size_t>(l) * n, n); };
+
+    thread_local std::array<HashState, L> hash;
+    std::array<ChaChaDrbg::Key, L> key;
+    std::array<size_t, L> msg{};
+    std::array<int, L> tries{};
+    std::array<double, L> u{};
+    std::array<bool, L> live{};
+    size_t next = 0;
+    auto refill = [&](const int l) {
+      live[l] = next < msgs.size();
+      if (!live[l]) return;
+      msg[l] = next++;
+      tries[l] = 0;
+      key[l] = threadDrbg().deriveKey();
+      H_init(P, hash[l]);
+      H_absorb(P, hash[l], msgs[msg[l]].data(), msgs[msg[l]].size());
+    };
+    for (int l = 0; l < L; ++l) refill(l);
+
+    while (std::ranges::any_of(live, [](const bool b) { return b; })) {
+      for (int l = 0; l < L; ++l) {
+        if (!live[l]) continue;
+        ChaChaDrbg rng(key[l], static_cast<uint64_t>(tries[l]));
+        drawMask(ctx, rng, lane(y1, l), lane(y2, l), u[l]);
+      }
+      gatherLanes<Ring>(P, y1, live, X);
+      mulBatch(X.data(), hb, R.data());
+      for (int l = 0; l < L; ++l) {
+        if (!live[l]) continue;
+        scatterLane<Ring>(P, R.data(), l, prod);
+        maskZ<Ring>(P, lane(y2, l), prod, lane(z, l));
+        H_finish(P, hash[l], lane(z, l), lane(eSmall, l), lane(eMod, l));
+        trapdoorS<Ring>(ctx, lane(eMod, l), lane(s, l));
+      }
+      gatherLanes<Ring>(P, s, live, X);
+      mulBatch(X.data(), hb, R.data());
+      for (int l = 0; l < L; ++l) {
+        if (!live[l]) continue;
+        scatterLane<Ring>(P, R.data(), l, prod);
+        const bool accepted =
+            trapdoorT<Ring>(ctx, lane(eMod, l), lane(s, l), prod, lane(t, l)) &&
+            acceptAttempt<Ring>(ctx, lane(y1, l), lane(y2, l), lane(eSmall, l), lane(eMod, l), lane(s, l), lane(t, l),
+                                u[l], sigs[msg[l]]);
+        if (accepted) ok[msg[l]] = true;
+        if (accepted || ++tries[l] >= P.MAX_SIGN_ATT) refill(l);
+      }
+    }
+  }
+
+  bool sign_attempt(const SignerContext &ctx, ChaChaDrbg &rng, const HashState &msgHash, Signature &sig) {
+    if (ctx.params.pow2) return signAttempt<Pow2Ring>(ctx, rng, msgHash, sig);
+    return signAttempt<GenericRing>(ctx, rng, msgHash, sig);
+  }
 }
 
-bool write_signed(const std::string &inPath, const std::vector<uint8_t> &msg, const Signature &S) {
-  std::ofstream out(inPath + ".signed", std::ios::binary);
-  if (!out) {
-    std::cerr << "Не удалось создать выходные данные\n";
-    return false;
+// после первого сообщения e_small состояния потока переиспользуется
+const HashState &hash_message(const Params &P, const std::vector<uint8_t> &msg) {
+  return hash_message(P, std::span<const uint8_t>(msg));
+}
+
+const HashState &hash_message(const Params &P, const std::span<const uint8_t> msg) {
+  thread_local HashState st;
+  H_init(P, st);
+  H_absorb(P, st, msg.data(), msg.size());
+  return st;
+}
+
+void sign_mask(const SignerContext &ctx, ChaChaDrbg &rng, SignMask &mask) {
+  const int n = ctx.params.N;
+  mask.y1.resize(n);
+  mask.y2.resize(n);
+  mask.z.resize(n);
+  if (ctx.params.pow2) prepareMask<Pow2Ring>(ctx, rng, mask.y1, mask.y2, mask.z, mask.u);
+  else prepareMask<GenericRing>(ctx, rng, mask.y1, mask.y2, mask.z, mask.u);
+}
+
+bool sign_with_mask(const SignerContext &ctx, const HashState &msgHash, const SignMask &mask, Signature &sig) {
+  if (ctx.params.pow2) return attemptWithMask<Pow2Ring>(ctx, msgHash, mask.y1, mask.y2, mask.z, mask.u, sig);
+  return attemptWithMask<GenericRing>(ctx, msgHash, mask.y1, mask.y2, mask.z, mask.u, sig);
+}
+
+bool NTRUSign_once(const SignerContext &ctx, const Poly &m, Poly &s_out, Poly &t_out) {
+  s_out.assign(ctx.params.N, 0);
+  t_out.assign(ctx.params.N, 0);
+  if (ctx.params.pow2) return signOnce<Pow2Ring>(ctx, m, s_out, t_out);
+  return signOnce<GenericRing>(ctx, m, s_out, t_out);
+}
+
+// Ключ подписи берётся из генератора потока, попытка k читает свой поток ChaCha20 под этим
+// ключом. Поэтому sign_strict и sign_parallel при одном состоянии генератора (drbgSeed)
+// выдают одну и ту же подпись.
+bool sign_strict(const SignerContext &ctx, const std::vector<uint8_t> &msg, Signature &sig) {
+  // сообщение поглощается один раз, в попытках дохэшируется только z
+  return sign_strict(ctx, hash_message(ctx.params, msg), sig);
+}
+
+bool sign_strict(const SignerContext &ctx, const HashState &msgHash, Signature &sig) {
+  const ChaChaDrbg::Key sigKey = threadDrbg().deriveKey();
+  for (int tries = 0; tries < ctx.params.MAX_SIGN_ATT; ++tries) {
+    ChaChaDrbg rng(sigKey, static_cast<uint64_t>(tries));
+    if (sign_attempt(ctx, rng, msgHash, sig)) return true;
   }
+  return false;
+}
 
-  constexpr char magic[4] = {'S', 'G', 'N', '1'};
-  out.write(magic, 4);
-  auto L = static_cast<uint64_t>(msg.size());
-  out.write(reinterpret_cast<const char *>(&L), sizeof(L));
+bool sign_parallel(const SignerContext &ctx, const std::vector<uint8_t> &msg, Signature &sig, const unsigned threads) {
+  return sign_parallel(ctx, hash_message(ctx.params, msg), sig, threads);
+}
 
-  int64_t ts = 0;
-  try {
-    const auto ftime = std::filesystem::last_write_time(inPath);
-    ts = static_cast<int64_t>(ftime.time_since_epoch().count());
-  } catch (...) { ts = 0; }
-  out.write(reinterpret_cast<const char *>(&ts), sizeof(ts));
+bool sign_parallel(const SignerContext &ctx, const HashState &msgHash, Signature &sig, const unsigned threads) {
+  if (threads <= 1) return sign_strict(ctx, msgHash, sig);
+  const ChaChaDrbg::Key sigKey = threadDrbg().deriveKey(); // msgHash рабочие потоки только читают
+  const int maxAttempts = ctx.params.MAX_SIGN_ATT;
 
-  if (L) out.write(reinterpret_cast<const char *>(msg.data()), (std::streamsize) L);
+  // Попытки нумеруются глобально; побеждает принятая попытка с наименьшим номером.
+  // Все попытки с меньшими номерами к этому моменту досчитаны и отвергнуты, поэтому
+  // результат распределён так же, как первая принятая в последовательном цикле.
+  std::atomic<int> next{0};
+  std::atomic<int> best{maxAttempts};
+  std::mutex m;
+  Signature bestSig;
 
-  auto write_poly_u16 = [&](const Poly &P) {
-    for (int i = 0; i < G_N; ++i) {
-      auto v = static_cast<uint16_t>(P[i]);
-      out.write(reinterpret_cast<const char *>(&v), sizeof(v));
+  auto worker = [&] {
+    Signature cand;
+    while (true) {
+      const int k = next.fetch_add(1);
+      if (k >= best.load()) return; // дальнейшие попытки уже не нужны
+      ChaChaDrbg rng(sigKey, static_cast<uint64_t>(k));
+      if (!sign_attempt(ctx, rng, msgHash, cand)) continue;
+      std::lock_guard lk(m);
+      if (k < best.load()) {
+        best.store(k);
+        bestSig = std::move(cand);
+      }
+      return;
     }
   };
-  write_poly_u16(S.x1);
-  write_poly_u16(S.x2);
-  write_poly_u16(S.e);
-  out.close();
-  std::cout << "Файл успешно подписан: " << inPath << ".signed\n";
+
+  std::vector<std::thread> pool;
+  pool.reserve(threads - 1);
+  for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+  worker();
+  for (auto &t: pool) t.join();
+
+  if (best.load() >= maxAttempts) return false;
+  sig = std::move(bestSig);
   return true;
 }
 
-bool read_signed(const std::string &path, std::pmr::vector<uint8_t> &msg, Signature &S, uint64_t &L, int64_t &ts) {
-  std::ifstream in(path, std::ios::binary | std::ios::ate);
-  if (!in) {
-    std::cerr << "Не удалось открыть файл " << path << "\n";
-    return false;
+std::vector<bool> sign_batch(const SignerContext &ctx, const std::span<const std::vector<uint8_t>> msgs,
+                             const std::span<Signature> sigs) {
+  std::vector<bool> ok(msgs.size());
+  PreparedOperand<uint16_t> h16;
+  PreparedOperand<uint32_t> h32;
+  if (ctx.params.pow2) {
+    signBatchWith<Pow2Ring>(ctx, msgs, sigs, batchKey16(ctx, h16), ok);
+  } else if (batchKey32(ctx, h32)) {
+    signBatchWith<GenericRing>(ctx, msgs, sigs, h32, ok);
+  } else {
+    for (size_t i = 0; i < msgs.size(); ++i) ok[i] = sign_strict(ctx, msgs[i], sigs[i]);
   }
-  std::streamoff fileSize = in.tellg();
-  in.seekg(0, std::ios::beg);
+  return ok;
+}
 
-  char magic[4];
-  in.read(magic, 4);
-  if (in.gcount() != 4 || magic[0] != 'S' || magic[1] != 'G' || magic[2] != 'N' || magic[3] != '1') {
-    std::cout << "Подпись недействительна (bad magic)\n";
-    return false;
+SigStatus verify_signature(const VerifierContext &ctx, const std::vector<uint8_t> &msg, const Signature &S) {
+  return verify_signature(ctx, hash_message(ctx.params, msg), S);
+}
+
+SigStatus verify_signature(const VerifierContext &ctx, const HashState &msgHash, const Signature &S) {
+  if (ctx.params.pow2) return verifyWith<Pow2Ring>(ctx, msgHash, S);
+  return verifyWith<GenericRing>(ctx, msgHash, S);
+}
+
+std::vector<bool> verify_batch(const VerifierContext &ctx, const std::span<const std::vector<uint8_t>> msgs,
+                               const std::span<const Signature> sigs, const std::span<SigStatus> status) {
+  std::vector<HashState> hashes;
+  hashes.reserve(msgs.size());
+  for (const std::vector<uint8_t> &msg: msgs) hashes.push_back(H_absorb_msg(ctx.params, msg));
+  return verify_batch(ctx, std::span<const HashState>(hashes), sigs, status);
+}
+
+std::vector<bool> verify_batch(const VerifierContext &ctx, const std::span<const HashState> hashes,
+                               const std::span<const Signature> sigs, const std::span<SigStatus> status) {
+  const Params &P = ctx.params;
+  const size_t count = sigs.size();
+  Arena &arena = threadArena();
+  const Arena::Scope scope(arena);
+  const std::span<SigStatus> st = status.empty() ? arena.alloc<SigStatus>(count) : status;
+
+  PreparedOperand<uint16_t> h16;
+  PreparedOperand<uint32_t> h32;
+  if (P.pow2) {
+    verifyBatchWith<Pow2Ring>(ctx, hashes, sigs, batchKey16(ctx, h16), st);
+  } else if (batchKey32(ctx, h32)) {
+    verifyBatchWith<GenericRing>(ctx, hashes, sigs, h32, st);
+  } else {
+    for (size_t i = 0; i < count; ++i) st[i] = verifyWith<GenericRing>(ctx, hashes[i], sigs[i]);
   }
-  in.read(reinterpret_cast<char *>(&L), sizeof(L));
-  in.read(reinterpret_cast<char *>(&ts), sizeof(ts));
 
-  size_t expected = 4 + 8 + 8 + static_cast<size_t>(L) + static_cast<size_t>(3 * G_N * 2);
-  if (fileSize != static_cast<std::streamoff>(expected)) {
-    std::cout << "Подпись недействительна (length mismatch)\n";
+  std::vector<bool> ok(count);
+  for (size_t i = 0; i < count; ++i) ok[i] = st[i] == SigStatus::Ok;
+  return ok;
+}
+
+const char *sigStatusName(const SigStatus s) {
+  switch (s) {
+    case SigStatus::Ok: return "ok";
+    case SigStatus::OpenError: return "open_error";
+    case SigStatus::WriteError: return "write_error";
+    case SigStatus::BadMagic: return "bad_magic";
+    case SigStatus::LengthMismatch: return "length_mismatch";
+    case SigStatus::SignFailed: return "sign_failed";
+    case SigStatus::OrigMissing: return "orig_missing";
+    case SigStatus::Modified: return "modified";
+    case SigStatus::HashMismatch: return "hash_mismatch";
+    case SigStatus::Norm: return "norm";
+  }
+  return "unknown";
+}
+
+namespace {
+  constexpr size_t SIGNED_HEADER = 4 + 8 + 8;
+
+  // магия по формату и кодировке
+  constexpr const char *SIGNED_MAGIC[2][2] = {{"SGN1", "SGN2"}, {"SIG1", "SIG2"}};
+}
+
+void write_signed_header(std::ostream &out, const SignedFormat format, const SigEncoding encoding, const uint64_t L,
+                         const int64_t ts) {
+  out.write(SIGNED_MAGIC[static_cast<int>(format)][static_cast<int>(encoding)], 4);
+  out.write(reinterpret_cast<const char *>(&L), sizeof(L));
+  out.write(reinterpret_cast<const char *>(&ts), sizeof(ts));
+}
+
+void write_signature(const Params &P, std::ostream &out, const Signature &S, const SigEncoding encoding) {
+  Arena &arena = threadArena();
+  const Arena::Scope scope(arena);
+  if (encoding == SigEncoding::Compact) {
+    const std::span<uint8_t> buf = arena.alloc<uint8_t>(compact_signature_bound(P));
+    const size_t len = encode_compact(P, S, buf);
+    if (len == 0) out.setstate(std::ios::failbit);
+    else out.write(reinterpret_cast<const char *>(buf.data()), static_cast<std::streamsize>(len));
+    return;
+  }
+  // три многочлена одной записью по 2 байта на коэффициент
+  const std::span<uint16_t> buf = arena.alloc<uint16_t>(3 * static_cast<size_t>(P.N));
+  for (int i = 0; i < P.N; ++i) {
+    buf[i] = static_cast<uint16_t>(S.x1[i]);
+    buf[P.N + i] = static_cast<uint16_t>(S.x2[i]);
+    buf[2 * P.N + i] = static_cast<uint16_t>(S.e[i]);
+  }
+  out.write(reinterpret_cast<const char *>(buf.data()), static_cast<std::streamsize>(buf.size_bytes()));
+}
+
+int64_t file_timestamp(const std::string &path) {
+  try {
+    const auto ftime = std::filesystem::last_write_time(path);
+    return static_cast<int64_t>(ftime.time_since_epoch().count());
+  } catch (...) { return 0; }
+}
+
+SigStatus write_signed(const Params &P, const std::string &inPath, const std::vector<uint8_t> &msg, const Signature &S,
+                       const SigEncoding encoding) {
+  std::ofstream out(inPath + ".signed", std::ios::binary);
+  if (!out) return SigStatus::WriteError;
+
+  write_signed_header(out, SignedFormat::Embedded, encoding, msg.size(), file_timestamp(inPath));
+  if (!msg.empty()) out.write(reinterpret_cast<const char *>(msg.data()), (std::streamsize) msg.size());
+  write_signature(P, out, S, encoding);
+  out.close();
+  return out ? SigStatus::Ok : SigStatus::WriteError;
+}
+
+namespace {
+  // формат и кодировка по магии; false -- не подписанный файл
+  bool parse_magic(const std::span<const uint8_t> file, SignedFormat &format, SigEncoding &encoding) {
+    if (file.size() < 4) return false;
+    for (const SignedFormat f: {SignedFormat::Embedded, SignedFormat::Detached})
+      for (const SigEncoding e: {SigEncoding::Raw, SigEncoding::Compact})
+        if (std::memcmp(file.data(), SIGNED_MAGIC[static_cast<int>(f)][static_cast<int>(e)], 4) == 0) {
+          format = f;
+          encoding = e;
+          return true;
+        }
     return false;
   }
-  msg.resize((size_t) L);
-  if (L > 0) in.read(reinterpret_cast<char *>(msg.data()), (std::streamsize) L);
+}
+
+SigStatus parse_signed_header(const std::span<const uint8_t> file, uint64_t &L, int64_t &ts) {
+  SignedFormat format;
+  SigEncoding encoding;
+  if (!parse_magic(file, format, encoding) || format != SignedFormat::Embedded) return SigStatus::BadMagic;
+  if (file.size() < SIGNED_HEADER) return SigStatus::LengthMismatch;
+  std::memcpy(&L, file.data() + 4, sizeof(L));
+  std::memcpy(&ts, file.data() + 12, sizeof(ts));
+  if (L > file.size() - SIGNED_HEADER) return SigStatus::LengthMismatch;
+  return SigStatus::Ok;
+}
+
+SigStatus parse_signed(const Params &P, const std::span<const uint8_t> file, SignedView &view) {
+  if (!parse_magic(file, view.format, view.encoding)) return SigStatus::BadMagic;
+  if (file.size() < SIGNED_HEADER) return SigStatus::LengthMismatch;
+  std::memcpy(&view.L, file.data() + 4, sizeof(view.L));
+  std::memcpy(&view.ts, file.data() + 12, sizeof(view.ts));
+  const size_t msgBytes = view.format == SignedFormat::Embedded ? static_cast<size_t>(view.L) : 0;
+  if (msgBytes > file.size() - SIGNED_HEADER) return SigStatus::LengthMismatch;
+  view.msg = file.subspan(SIGNED_HEADER, msgBytes);
+  view.sig = file.subspan(SIGNED_HEADER + msgBytes);
+  if (view.encoding == SigEncoding::Raw && view.sig.size() != 6 * static_cast<size_t>(P.N))
+    return SigStatus::LengthMismatch;
+  return SigStatus::Ok;
+}
 
-  auto read_poly_u16 = [&](Poly &P) {
-    P.assign(G_N, 0);
-    for (int i = 0; i < G_N; ++i) {
+SigStatus decode_signature(const Params &P, const SignedView &view, Signature &S) {
+  if (view.encoding == SigEncoding::Compact)
+    return decode_compact(P, view.sig, S) ? SigStatus::Ok : SigStatus::LengthMismatch;
+  // смещение многочленов зависит от L и может быть нечётным -- чтение через memcpy
+  const size_t polyBytes = 2 * static_cast<size_t>(P.N);
+  auto decode = [&](const std::span<const uint8_t> raw, Poly &A) {
+    A.resize(P.N);
+    for (int i = 0; i < P.N; ++i) {
       uint16_t v;
-      in.read(reinterpret_cast<char *>(&v), sizeof(v));
-      P[i] = static_cast<int>(v);
+      std::memcpy(&v, raw.data() + 2 * static_cast<size_t>(i), sizeof(v));
+      A[i] = static_cast<int>(v);
     }
   };
-  read_poly_u16(S.x1);
-  read_poly_u16(S.x2);
-  read_poly_u16(S.e);
-  return true;
+  decode(view.sig.first(polyBytes), S.x1);
+  decode(view.sig.subspan(polyBytes, polyBytes), S.x2);
+  decode(view.sig.subspan(2 * polyBytes, polyBytes), S.e);
+  return SigStatus::Ok;
+}
+
+SigStatus read_signed(const Params &P, const std::string &path, std::vector<uint8_t> &msg, Signature &S, uint64_t &L, int64_t &ts) {
+  MappedFile file;
+  if (!file.open(path)) return SigStatus::OpenError;
+  SignedView view;
+  const SigStatus ps = parse_signed(P, file.bytes(), view);
+  if (ps != SigStatus::Ok) return ps;
+  if (view.format != SignedFormat::Embedded) return SigStatus::BadMagic;
+  L = view.L;
+  ts = view.ts;
+  msg.assign(view.msg.begin(), view.msg.end());
+  return decode_signature(P, view, S);
 }
@@ -0,0 +1,91 @@
+#include <utility>
+
+#include "ntru/presign.hpp"
+
+PresignPool::PresignPool(const SignerContext &ctx, const size_t capacity, const unsigned workers)
+  : ctx_(ctx), key_(threadDrbg().deriveKey()), slots_(capacity) {
+  // память слотов выделяется сразу, дальше маски только обмениваются
+  for (SignMask &s: slots_) {
+    s.y1.resize(ctx.params.N);
+    s.y2.resize(ctx.params.N);
+    s.z.resize(ctx.params.N);
+  }
+  if (capacity == 0) return;
+  workers_.reserve(workers);
+  for (unsigned i = 0; i < workers; ++i) workers_.emplace_back(&PresignPool::work, this);
+}
+
+PresignPool::~PresignPool() {
+  {
+    std::lock_guard lk(m_);
+    stop_ = true;
+  }
+  notFull_.notify_all();
+  for (auto &t: workers_) t.join();
+}
+
+void PresignPool::produce(SignMask &mask) {
+  ChaChaDrbg rng(key_, nextStream_.fetch_add(1));
+  sign_mask(ctx_, rng, mask);
+}
+
+void PresignPool::work() {
+  SignMask mask;
+  auto ready = [this] { return stop_ || count_ < slots_.size(); };
+  while (true) {
+    {
+      std::unique_lock lk(m_);
+      notFull_.wait(lk, ready);
+      if (stop_) return;
+    }
+    produce(mask);
+
+    // пока маска считалась, пул могли заполнить другие потоки
+    std::unique_lock lk(m_);
+    notFull_.wait(lk, ready);
+    if (stop_) return;
+    std::swap(slots_[(head_ + count_) % slots_.size()], mask);
+    ++count_;
+    ++stats_.produced;
+  }
+}
+
+bool PresignPool::take(SignMask &mask) {
+  std::lock_guard lk(m_);
+  if (count_ == 0) {
+    ++stats_.empty;
+    return false;
+  }
+  std::swap(slots_[head_], mask);
+  head_ = (head_ + 1) % slots_.size();
+  --count_;
+  ++stats_.fromPool;
+  return true;
+}
+
+bool PresignPool::sign(const std::vector<uint8_t> &msg, Signature &sig) {
+  return sign(hash_message(ctx_.params, msg), sig);
+}
+
+bool PresignPool::sign(const HashState &msgHash, Signature &sig) {
+  // буферы маски потока после обмена с пулом уходят в пул, взамен приходят его
+  thread_local SignMask mask;
+  bool ok = false;
+  for (int tries = 0; tries < ctx_.params.MAX_SIGN_ATT && !ok; ++tries) {
+    if (!take(mask)) produce(mask);
+    ok = sign_with_mask(ctx_, msgHash, mask, sig);
+  }
+  {
+    std::lock_guard lk(m_);
+    if (ok) ++stats_.signatures;
+  }
+  // пополнение будится после онлайн-вызова, а не на каждой маске: иначе при нехватке
+  // ядер фоновый поток вытесняет ещё идущую подпись
+  notFull_.notify_all();
+  return ok;
+}
+
+PresignStats PresignPool::stats() const {
+  std::lock_guard lk(m_);
+  return stats_;
+}
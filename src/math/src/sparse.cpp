@@ -0,0 +1,23 @@
+#include "../include/sparse.hpp"
+
+bool toSparseTernary(const Poly &a, const int q, SparseTernary &out) {
+  out.plus.clear();
+  out.minus.clear();
+  for (int i = 0; i < static_cast<int>(a.size()); ++i) {
+    int v = a[i] % q;
+    if (v < 0) v += q;
+    if (v == 0) continue;
+    if (v == 1) out.plus.push_back(i);
+    else if (v == q - 1) out.minus.push_back(i);
+    else return false;
+  }
+  return true;
+}
+
+void mulSparseAcc(const int *a, const SparseTernary &t, const int n, long long *acc) {
+  mulSparseAccN<0>(a, t, n, acc);
+}
+
+void mulSparsePair(const int *a, const SparseTernary &f, const SparseTernary &g, const int n, long long *af, long long *ag) {
+  mulSparsePairN<0>(a, f, g, n, af, ag);
+}
@@ -0,0 +1,32 @@
+#include <algorithm>
+#include <cstdint>
+
+#include "../include/workspace.hpp"
+
+void *Arena::raw(size_t bytes) {
+  bytes = (bytes + ALIGN - 1) & ~(ALIGN - 1);
+  while (true) {
+    if (block_ < blocks_.size()) {
+      Block &b = blocks_[block_];
+      if (offset_ + bytes <= b.size) {
+        void *p = b.base + offset_;
+        offset_ += bytes;
+        return p;
+      }
+      // не помещается -- следующий блок (память текущего остаётся за внешними Scope)
+      ++block_;
+      offset_ = 0;
+      continue;
+    }
+    const size_t size = std::max(BLOCK_BYTES, bytes);
+    Block b{std::make_unique<std::byte[]>(size + ALIGN), nullptr, size};
+    const auto addr = reinterpret_cast<uintptr_t>(b.mem.get());
+    b.base = b.mem.get() + ((ALIGN - addr % ALIGN) % ALIGN);
+    blocks_.push_back(std::move(b));
+  }
+}
+
+Arena &threadArena() {
+  thread_local Arena arena;
+  return arena;
+}
@@ -0,0 +1,400 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "common.hpp"
+#include "arithmetic.hpp"
+#include "hash.hpp"
+#include "mapped_file.hpp"
+#include "console/utils.hpp"
+#include "ntru/keys.hpp"
+#include "ntru/ntru.hpp"
+#include "ntru/presign.hpp"
+#include "operations.hpp"
+#include "thread_pool.hpp"
+
+// ---------------------------- Загрузка/сохранение параметров и ключей ----------------------------
+bool LoadParameters(const std::string &paramPath, Params &P) {
+  std::ifstream in(paramPath);
+  if (!in) {
+    std::cerr << "Не удалось открыть файл параметров: " << paramPath << "\n";
+    return false;
+  }
+
+  P = Params{};
+  std::string line;
+  int have = 0;
+  while (getline(in, line)) {
+    line = trim(line);
+    if (line.empty() || line[0] == '#') continue;
+    const size_t eq = line.find('=');
+    if (eq == std::string::npos) continue;
+    std::string k = trim(line.substr(0, eq)), v = trim(line.substr(eq + 1));
+    if (k == "N") {
+      P.N = stoi(v);
+      have++;
+    } else if (k == "Q") {
+      P.Q = stoi(v);
+      have++;
+    } else if (k == "D") {
+      P.D = stoi(v);
+      have++;
+    } else if (k == "NU") {
+      P.NU = stod(v);
+      have++;
+    } else if (k == "NORM_BOUND") {
+      P.NORM_BOUND = stoi(v);
+      have++;
+    } else if (k == "ETA") {
+      P.ETA = stod(v);
+      have++;
+    } else if (k == "ALPHA") {
+      P.ALPHA = stoi(v);
+      have++;
+    } else if (k == "SIGMA") {
+      P.SIGMA = stoi(v);
+      have++;
+    } else if (k == "MAX_SIGN_ATTEMPTS_MASK") { P.MAX_SIGN_ATT = stoi(v); }
+  }
+  if (have < 8) {
+    std::cerr << "Файл параметров неполный. Требуются: N,Q,D,NU,NORM_BOUND,ETA,ALPHA,SIGMA\n";
+    return false;
+  }
+  if (P.N <= 0 || P.Q <= 0 || P.D <= 0 || P.SIGMA <= 0 || P.ALPHA < 0) {
+    std::cerr << "Некорректные значения параметров.\n";
+    return false;
+  }
+
+  prepareParams(P);
+  return true;
+}
+
+bool WritePublicKey(const VerifierContext &ctx, const std::string &finalPath, const PublicKeyFormat format) {
+  if (format == PublicKeyFormat::Binary) return write_public_key(ctx, finalPath);
+  const int n = ctx.params.N;
+  std::ofstream out(finalPath, std::ios::binary | std::ios::trunc);
+  if (!out) return false;
+  out << n << "\n";
+  for (int i = 0; i < n; ++i) {
+    out << ctx.h[i];
+    if (i + 1 < n) out << ' ';
+  }
+  out << "\n";
+  out.close();
+  return static_cast<bool>(out);
+}
+
+bool SavePublicKeyAtLocation(const VerifierContext &ctx, const std::string &userPath) {
+  const std::string finalPath = to_target_file_path(userPath);
+  if (!ensure_parent_dirs(finalPath)) {
+    std::cout << "Не удалось создать родительские каталоги для: " << finalPath << "\n";
+    return false;
+  }
+  if (!WritePublicKey(ctx, finalPath)) {
+    std::cout << "Не удалось создать файл открытого ключа: " << finalPath << "\n";
+    return false;
+  }
+  std::cout << "Открытый ключ сохранён в: " << finalPath << "\n";
+  return true;
+}
+
+bool SavePrivateKeyAtLocation(const SignerContext &ctx, const std::string &userPath) {
+  const std::string finalPath = to_target_file_path(userPath, "private.key");
+  if (!ensure_parent_dirs(finalPath)) {
+    std::cout << "Не удалось создать родительские каталоги для: " << finalPath << "\n";
+    return false;
+  }
+  if (!write_private_key(ctx, finalPath)) return false;
+  std::cout << "Закрытый ключ сохранён в: " << finalPath << "\n";
+  return true;
+}
+
+bool LoadPublicKey(VerifierContext &ctx, const std::string &pubPath) {
+  const Params &P = ctx.params;
+  std::ifstream in(pubPath, std::ios::binary);
+  if (!in) {
+    std::cerr << "Не удалось открыть файл открытого ключа: " << pubPath << "\n";
+    return false;
+  }
+  uint8_t magic[4] = {};
+  in.read(reinterpret_cast<char *>(magic), sizeof(magic));
+  if (is_binary_public_key(std::span<const uint8_t>(magic, static_cast<size_t>(in.gcount())))) {
+    in.close();
+    return read_public_key(ctx, pubPath);
+  }
+  // текстовый формат
+  in.clear();
+  in.seekg(0);
+  int n_in = 0;
+  if (!(in >> n_in)) {
+    std::cerr << "Некорректный формат открытого ключа (ожидался N)\n";
+    return false;
+  }
+  if (n_in != P.N) {
+    std::cerr << "Несоответствие N: params.N=" << P.N << ", key.N=" << n_in << "\n";
+    return false;
+  }
+  ctx.h.assign(P.N, 0);
+  for (int i = 0; i < P.N; ++i) {
+    long long v;
+    if (!(in >> v)) {
+      std::cerr << "Недостаточно коэффициентов в файле ключа\n";
+      return false;
+    }
+    ctx.h[i] = modQ(P, v);
+  }
+  expandPublicKey(ctx);
+  return true;
+}
+
+// ---------------------------- Операции над файлами ----------------------------
+namespace {
+  constexpr size_t SIGN_CHUNK = size_t{1} << 20;
+
+  // Потоковая подпись: файл читается кусками по SIGN_CHUNK, каждый кусок поглощается
+  // хэшем и сразу пишется в .signed -- память не зависит от размера файла. Отсоединённая
+  // подпись (.sig) получает только заголовок и подпись, сообщение не копируется. Вывод идёт
+  // во временный файл и переименовывается после принятой подписи, так что при отказе
+  // прежний файл подписи не затирается.
+  template<typename SignFn>
+  SigStatus signFileWith(const Params &P, const std::string &path, const SignedFormat format,
+                         const SigEncoding encoding, SignFn &&sign) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return SigStatus::OpenError;
+    std::error_code ec;
+    const uintmax_t L = std::filesystem::file_size(path, ec);
+    if (ec) return SigStatus::OpenError;
+    const int64_t ts = file_timestamp(path);
+
+    const bool embed = format == SignedFormat::Embedded;
+    const std::string outPath = path + (embed ? ".signed" : ".sig");
+    const std::string tmpPath = outPath + ".tmp";
+    std::ofstream out(tmpPath, std::ios::binary);
+    if (!out) return SigStatus::WriteError;
+    auto fail = [&](const SigStatus status) {
+      out.close();
+      std::filesystem::remove(tmpPath, ec);
+      return status;
+    };
+
+    write_signed_header(out, format, encoding, L, ts);
+    thread_local HashState st;
+    H_init(P, st);
+    std::vector<char> buf(static_cast<size_t>(std::min<uintmax_t>(L, SIGN_CHUNK)));
+    for (uintmax_t left = L; left > 0;) {
+      const auto len = static_cast<std::streamsize>(std::min<uintmax_t>(left, buf.size()));
+      // файл стал короче, чем при открытии
+      if (!in.read(buf.data(), len)) return fail(SigStatus::LengthMismatch);
+      H_absorb(P, st, reinterpret_cast<const uint8_t *>(buf.data()), static_cast<size_t>(len));
+      if (embed) out.write(buf.data(), len);
+      left -= static_cast<uintmax_t>(len);
+    }
+    if (!out) return fail(SigStatus::WriteError);
+
+    Signature S;
+    if (!sign(st, S)) return fail(SigStatus::SignFailed);
+    write_signature(P, out, S, encoding);
+    out.close();
+    if (!out) return fail(SigStatus::WriteError);
+    std::filesystem::rename(tmpPath, outPath, ec);
+    if (ec) return fail(SigStatus::WriteError);
+    return SigStatus::Ok;
+  }
+}
+
+SigStatus signFile(const SignerContext &ctx, const std::string &path, const unsigned signThreads,
+                   const SignedFormat format, const SigEncoding encoding) {
+  return signFileWith(ctx.params, path, format, encoding, [&](const HashState &msgHash, Signature &S) {
+    return sign_parallel(ctx, msgHash, S, signThreads);
+  });
+}
+
+SigStatus signFile(PresignPool &pool, const std::string &path, const SignedFormat format,
+                   const SigEncoding encoding) {
+  return signFileWith(pool.context().params, path, format, encoding, [&](const HashState &msgHash, Signature &S) {
+    return pool.sign(msgHash, S);
+  });
+}
+
+namespace {
+  // .signed отображается в память: заголовок и подпись разбираются из отображения,
+  // сообщение поглощается хэшем прямо из него (без копии); плюс проверка исходника
+  // (наличие, время изменения) -- всё, кроме самой подписи. У отсоединённой .sig
+  // сообщением служит сам исходник: он отображается и должен иметь длину L.
+  SigStatus loadSignedFile(const Params &P, const std::string &signedPath, const std::string &origPath,
+                           HashState &msgHash, Signature &S) {
+    MappedFile file;
+    if (!file.open(signedPath)) return SigStatus::OpenError;
+    SignedView view;
+    const SigStatus ps = parse_signed(P, file.bytes(), view);
+    if (ps != SigStatus::Ok) return ps;
+
+    if (!std::filesystem::exists(origPath)) return SigStatus::OrigMissing;
+    if (file_timestamp(origPath) != view.ts) return SigStatus::Modified;
+
+    const SigStatus ds = decode_signature(P, view, S);
+    if (ds != SigStatus::Ok) return ds;
+    MappedFile orig;
+    std::span<const uint8_t> msg = view.msg;
+    if (view.format == SignedFormat::Detached) {
+      if (!orig.open(origPath)) return SigStatus::OpenError;
+      if (orig.bytes().size() != view.L) return SigStatus::Modified;
+      msg = orig.bytes();
+    }
+    H_init(P, msgHash);
+    H_absorb(P, msgHash, msg.data(), msg.size());
+    return SigStatus::Ok;
+  }
+}
+
+SigStatus verifyFile(const VerifierContext &ctx, const std::string &signedPath, const std::string &origPath) {
+  thread_local HashState msgHash;
+  thread_local Signature S;
+  const SigStatus ls = loadSignedFile(ctx.params, signedPath, origPath, msgHash, S);
+  if (ls != SigStatus::Ok) return ls;
+  return verify_signature(ctx, msgHash, S);
+}
+
+SigStatus extractMessage(const Params &P, const std::string &signedPath, std::string &outPath) {
+  // из отображения читается только заголовок, само сообщение копирует ядро
+  MappedFile file;
+  if (!file.open(signedPath)) return SigStatus::OpenError;
+  SignedView view;
+  const SigStatus ps = parse_signed(P, file.bytes(), view);
+  if (ps != SigStatus::Ok) return ps;
+  if (view.format != SignedFormat::Embedded) return SigStatus::BadMagic;
+  const auto offset = static_cast<uint64_t>(view.msg.data() - file.bytes().data());
+  file.close();
+
+  outPath = signedPath + ".restored.txt";
+  return copy_file_part(signedPath, offset, view.L, outPath) ? SigStatus::Ok : SigStatus::WriteError;
+}
+
+std::string originalPathOf(const std::string &signedPath) {
+  std::string origPath = signedPath;
+  if (origPath.ends_with(".sig")) {
+    origPath.resize(origPath.size() - 4);
+    return origPath;
+  }
+  size_t pos = origPath.rfind(".signed");
+  if (pos != std::string::npos) origPath.erase(pos);
+  return origPath;
+}
+
+// ---------------------------- Пакетная обработка ----------------------------
+BatchReport runBatch(const std::vector<std::string> &paths, const unsigned threads,
+                     const std::function<SigStatus(const std::string &)> &op) {
+  BatchReport rep;
+  rep.status.assign(paths.size(), SigStatus::Ok);
+  const auto t0 = std::chrono::steady_clock::now();
+  WorkStealingPool pool(threads);
+  pool.parallelFor(paths.size(), [&](const size_t i) { rep.status[i] = op(paths[i]); });
+  rep.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  for (const SigStatus st: rep.status) rep.ok += (st == SigStatus::Ok);
+  return rep;
+}
+
+BatchReport verifyBatch(const VerifierContext &ctx, const std::vector<std::string> &signedPaths, const unsigned threads) {
+  // файлы делятся на группы по VERIFY_GROUP, группы -- задачи пула; внутри группы все
+  // загруженные подписи проверяются одним verify_batch
+  constexpr size_t VERIFY_GROUP = 4 * MUL_BATCH_LANES;
+  BatchReport rep;
+  rep.status.assign(signedPaths.size(), SigStatus::Ok);
+  const auto t0 = std::chrono::steady_clock::now();
+  WorkStealingPool pool(threads);
+  const size_t groups = (signedPaths.size() + VERIFY_GROUP - 1) / VERIFY_GROUP;
+  pool.parallelFor(groups, [&](const size_t g) {
+    const size_t begin = g * VERIFY_GROUP;
+    const size_t end = std::min(signedPaths.size(), begin + VERIFY_GROUP);
+    // на подпись хранится только состояние хэша (O(N)), не сообщение
+    std::vector<HashState> hashes(end - begin);
+    std::vector<Signature> sigs(end - begin);
+    std::vector<size_t> index; // позиция загруженной подписи во входе
+    size_t loaded = 0;
+    for (size_t i = begin; i < end; ++i) {
+      rep.status[i] = loadSignedFile(ctx.params, signedPaths[i], originalPathOf(signedPaths[i]), hashes[loaded],
+                                     sigs[loaded]);
+      if (rep.status[i] != SigStatus::Ok) continue;
+      index.push_back(i);
+      ++loaded;
+    }
+    std::vector<SigStatus> st(loaded);
+    verify_batch(ctx, std::span<const HashState>(hashes.data(), loaded), std::span<const Signature>(sigs.data(), loaded),
+                 st);
+    for (size_t k = 0; k < index.size(); ++k) rep.status[index[k]] = st[k];
+  });
+  rep.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  for (const SigStatus st: rep.status) rep.ok += (st == SigStatus::Ok);
+  return rep;
+}
+
+// ---------------------------- Версии для меню ----------------------------
+bool SignFile(const SignerContext &ctx, const std::string &path) {
+  switch (signFile(ctx, path)) {
+    case SigStatus::Ok:
+      std::cout << "Файл успешно подписан: " << path << ".signed\n";
+      return true;
+    case SigStatus::OpenError:
+      std::cerr << "Не удалось открыть файл: " << path << "\n";
+      return false;
+    case SigStatus::SignFailed:
+      std::cerr << "Подпись не удалась (rejection stage)\n";
+      return false;
+    default:
+      std::cerr << "Не удалось создать выходные данные\n";
+      return false;
+  }
+}
+
+bool VerifyFileExternal(const VerifierContext &ctx, const std::string &signedPath, const std::string &origPath) {
+  switch (verifyFile(ctx, signedPath, origPath)) {
+    case SigStatus::Ok:
+      std::cout << "Подпись ДЕЙСТВИТЕЛЬНА для файла: " << origPath << "\n";
+      return true;
+    case SigStatus::OpenError:
+      std::cerr << "Не удалось открыть файл " << signedPath << "\n";
+      return false;
+    case SigStatus::BadMagic:
+      std::cout << "Подпись недействительна (bad magic)\n";
+      return false;
+    case SigStatus::LengthMismatch:
+      std::cout << "Подпись недействительна (length mismatch)\n";
+      return false;
+    case SigStatus::OrigMissing:
+      std::cout << "Исходный файл отсутствует → подпись недействительна\n";
+      return false;
+    case SigStatus::Modified:
+      std::cout << "Подпись недействительна (файл был модифицирован)\n";
+      return false;
+    case SigStatus::HashMismatch:
+      std::cout << "Подпись недействительна (hash mismatch)\n";
+      return false;
+    default:
+      std::cout << "Подпись недействительна (norm)\n";
+      return false;
+  }
+}
+
+bool ExtractMessage(const Params &P, const std::string &signedPath) {
+  std::string outPath;
+  switch (extractMessage(P, signedPath, outPath)) {
+    case SigStatus::Ok:
+      std::cout << "Исходное сообщение помещено в: " << outPath << "\n";
+      return true;
+    case SigStatus::OpenError:
+      std::cerr << "Не удалось открыть " << signedPath << "\n";
+      return false;
+    case SigStatus::BadMagic:
+      std::cout << "Не подписанный файл\n";
+      return false;
+    case SigStatus::LengthMismatch:
+      std::cout << "Подписанный файл поврежден\n";
+      return false;
+    default:
+      std::cerr << "Не удалось создать " << outPath << "\n";
+      return false;
+  }
+}
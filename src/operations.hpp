@@ -0,0 +1,73 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "ntru/ntru.hpp"
+
+class PresignPool;
+
+// ---------------------------- Загрузка/сохранение параметров и ключей ----------------------------
+// заполняет P и вызывает prepareParams
+bool LoadParameters(const std::string &paramPath, Params &P);
+
+// Открытый ключ пишется в двоичном формате NPK1 (keys.hpp) или текстом для обмена:
+// N, затем N коэффициентов через пробел
+enum class PublicKeyFormat { Binary, Text };
+
+// запись ровно по указанному пути, без сообщений
+bool WritePublicKey(const VerifierContext &ctx, const std::string &finalPath,
+                    PublicKeyFormat format = PublicKeyFormat::Binary);
+
+bool SavePublicKeyAtLocation(const VerifierContext &ctx, const std::string &userPath);
+
+bool SavePrivateKeyAtLocation(const SignerContext &ctx, const std::string &userPath);
+
+// ctx.params должны быть уже загружены; формат (двоичный или текст) определяется по магии
+bool LoadPublicKey(VerifierContext &ctx, const std::string &pubPath);
+
+// ---------------------------- Операции над файлами ----------------------------
+// Ничего не печатают, итог -- в SigStatus (общие для меню и пакетного CLI)
+// signThreads > 1 -- спекулятивные попытки подписи в нескольких потоках (sign_parallel);
+// format: Embedded -- path + ".signed" с копией файла, Detached -- path + ".sig" без неё;
+// encoding: Compact -- подпись кодом Голомба-Райса (codec.hpp), в несколько раз короче Raw
+SigStatus signFile(const SignerContext &ctx, const std::string &path, unsigned signThreads = 1,
+                   SignedFormat format = SignedFormat::Embedded, SigEncoding encoding = SigEncoding::Raw);
+
+// онлайн-подпись: маски попыток берутся из пула предвычислений
+SigStatus signFile(PresignPool &pool, const std::string &path, SignedFormat format = SignedFormat::Embedded,
+                   SigEncoding encoding = SigEncoding::Raw);
+
+// формат (.signed или .sig) и кодировка подписи определяются по магии файла подписи
+SigStatus verifyFile(const VerifierContext &ctx, const std::string &signedPath, const std::string &origPath);
+
+SigStatus extractMessage(const Params &P, const std::string &signedPath, std::string &outPath);
+
+// "file.txt.signed" -> "file.txt", "file.txt.sig" -> "file.txt"
+std::string originalPathOf(const std::string &signedPath);
+
+// ---------------------------- Пакетная обработка ----------------------------
+struct BatchReport {
+  std::vector<SigStatus> status; // по одному на путь, в порядке входа
+  size_t ok = 0;
+  double seconds = 0;
+
+  double filesPerSecond() const { return seconds > 0 ? static_cast<double>(status.size()) / seconds : 0.0; }
+};
+
+// op вызывается параллельно на пуле с кражей работы (threads = 0 -- по числу ядер);
+// op должна только читать контексты (параметры и ключи)
+BatchReport runBatch(const std::vector<std::string> &paths, unsigned threads,
+                     const std::function<SigStatus(const std::string &)> &op);
+
+// проверка многих .signed и .sig одним открытым ключом (исходник -- путь без ".signed" или ".sig");
+// подписи проверяются пачками через verify_batch, итоги те же, что у verifyFile
+BatchReport verifyBatch(const VerifierContext &ctx, const std::vector<std::string> &signedPaths, unsigned threads);
+
+// ---------------------------- Версии для меню (печатают результат) ----------------------------
+bool SignFile(const SignerContext &ctx, const std::string &path);
+
+bool VerifyFileExternal(const VerifierContext &ctx, const std::string &signedPath, const std::string &origPath);
+
+bool ExtractMessage(const Params &P, const std::string &signedPath);
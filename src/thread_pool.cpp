@@ -0,0 +1,93 @@
+#include <algorithm>
+
+#include "thread_pool.hpp"
+
+WorkStealingPool::WorkStealingPool(const unsigned threads) {
+  n_ = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+  ranges_ = std::make_unique<Range[]>(n_);
+  for (unsigned id = 1; id < n_; ++id) threads_.emplace_back(&WorkStealingPool::workerLoop, this, id);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard lk(m_);
+    stop_ = true;
+  }
+  startCv_.notify_all();
+  for (auto &t: threads_) t.join();
+}
+
+void WorkStealingPool::parallelFor(const size_t count, const std::function<void(size_t)> &fn) {
+  if (count == 0) return;
+  for (unsigned id = 0; id < n_; ++id) {
+    std::lock_guard lk(ranges_[id].m);
+    ranges_[id].begin = count * id / n_;
+    ranges_[id].end = count * (id + 1) / n_;
+  }
+  {
+    std::lock_guard lk(m_);
+    job_ = &fn;
+    running_ = n_;
+    ++gen_;
+  }
+  startCv_.notify_all();
+
+  runRanges(0);
+
+  std::unique_lock lk(m_);
+  --running_;
+  doneCv_.wait(lk, [this] { return running_ == 0; });
+  job_ = nullptr;
+}
+
+void WorkStealingPool::workerLoop(const unsigned id) {
+  uint64_t seen = 0;
+  while (true) {
+    {
+      std::unique_lock lk(m_);
+      startCv_.wait(lk, [&] { return stop_ || gen_ != seen; });
+      if (stop_) return;
+      seen = gen_;
+    }
+    runRanges(id);
+    {
+      std::lock_guard lk(m_);
+      if (--running_ == 0) doneCv_.notify_all();
+    }
+  }
+}
+
+void WorkStealingPool::runRanges(const unsigned id) {
+  const std::function<void(size_t)> &fn = *job_;
+  size_t i;
+  while (popOwn(id, i) || (steal(id) && popOwn(id, i))) fn(i);
+}
+
+bool WorkStealingPool::popOwn(const unsigned id, size_t &i) {
+  Range &r = ranges_[id];
+  std::lock_guard lk(r.m);
+  if (r.begin >= r.end) return false;
+  i = r.begin++;
+  return true;
+}
+
+bool WorkStealingPool::steal(const unsigned id) {
+  for (unsigned k = 1; k < n_; ++k) {
+    Range &victim = ranges_[(id + k) % n_];
+    size_t b, e;
+    {
+      std::lock_guard lk(victim.m);
+      if (victim.begin >= victim.end) continue;
+      const size_t take = (victim.end - victim.begin + 1) / 2;
+      e = victim.end;
+      b = e - take;
+      victim.end = b;
+    }
+    Range &own = ranges_[id];
+    std::lock_guard lk(own.m);
+    own.begin = b;
+    own.end = e;
+    return true;
+  }
+  return false;
+}
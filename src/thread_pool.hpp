@@ -0,0 +1,54 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул потоков с кражей работы для parallelFor по индексам.
+// Диапазон [0, count) делится поровну между потоками; поток берёт индексы
+// с начала своего диапазона, а опустевший -- крадёт половину чужого с конца.
+class WorkStealingPool {
+public:
+  explicit WorkStealingPool(unsigned threads = 0); // 0 -- по числу ядер
+
+  ~WorkStealingPool();
+
+  WorkStealingPool(const WorkStealingPool &) = delete;
+
+  WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+  unsigned size() const { return n_; }
+
+  // fn(i) для всех i из [0, count); вызывающий поток тоже работает, возврат -- когда всё сделано
+  void parallelFor(size_t count, const std::function<void(size_t)> &fn);
+
+private:
+  struct alignas(64) Range {
+    std::mutex m;
+    size_t begin = 0, end = 0;
+  };
+
+  void workerLoop(unsigned id);
+
+  void runRanges(unsigned id);
+
+  bool popOwn(unsigned id, size_t &i);
+
+  bool steal(unsigned id);
+
+  unsigned n_;
+  std::unique_ptr<Range[]> ranges_;
+  std::vector<std::thread> threads_;
+
+  std::mutex m_;
+  std::condition_variable startCv_, doneCv_;
+  const std::function<void(size_t)> *job_ = nullptr;
+  uint64_t gen_ = 0;
+  unsigned running_ = 0;
+  bool stop_ = false;
+};